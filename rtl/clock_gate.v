@@ -0,0 +1,31 @@
+module clock_gate (
+    input  logic clk,
+    input  logic en,       // functional enable (sampled while clk is low)
+    input  logic test_en,  // scan/test override, keeps the clock running
+    output logic gclk
+);
+
+`ifdef ICG_CELL
+    // Library integrated clock gate (CK/E/SE/GCK pins), set through
+    // my_icg_cell (DC) or ::ICG_CELL (Genus)
+    `ICG_CELL icg (
+        .CK  (clk),
+        .E   (en),
+        .SE  (test_en),
+        .GCK (gclk)
+    );
+`else
+    // Generic latch-based gate: the enable is captured while the clock is
+    // low, so gclk never glitches. Synthesises to a latch and an AND gate;
+    // the tools infer clock-gating checks on the AND.
+    logic en_latch;
+
+    always_latch begin
+        if (!clk)
+            en_latch = en | test_en;
+    end
+
+    assign gclk = clk & en_latch;
+`endif
+
+endmodule
@@ -1,39 +1,60 @@
 module credit_manager #(
     parameter int NUM_PORTS   = 5,
-    parameter int FIFO_DEPTH = 8
+    parameter int FIFO_DEPTH = 8,
+    parameter int DOWNSTREAM_DEPTH = FIFO_DEPTH  // input buffer of the next router
 )(
     input  logic                  clk,
     input  logic                  rst,
 
-    // Credit returned from output queues (packet sent out)
+    // Packets leaving the output queues onto the links
     input  logic [NUM_PORTS-1:0]  outq_credit_return,
 
-    // Credit coming from downstream routers
+    // Output queue slots taken (packet granted into the queue)
+    input  logic [NUM_PORTS-1:0]  outq_credit_take,
+
+    // Credit coming from downstream routers (one buffer slot freed)
     input  logic [NUM_PORTS-1:0]  downstream_credit,
 
-    // Can this output port send a packet?
+    // Can this output port send a packet downstream?
     output logic [NUM_PORTS-1:0]  can_send,
 
-    // Credit returned upstream
-    output logic [NUM_PORTS-1:0]  upstream_credit
+    // Can this output queue take a packet this cycle?
+    output logic [NUM_PORTS-1:0]  credit_avail
 );
 
     localparam int CREDIT_W = $clog2(FIFO_DEPTH + 1);
+    localparam int DS_W     = $clog2(DOWNSTREAM_DEPTH + 1);
 
-    logic [CREDIT_W-1:0] credit_cnt [NUM_PORTS];
+    // Free output queue slots, and free buffer slots downstream
+    logic [CREDIT_W-1:0] slot_cnt   [NUM_PORTS];
+    logic [DS_W-1:0]     credit_cnt [NUM_PORTS];
 
     genvar p;
     generate
         for (p = 0; p < NUM_PORTS; p++) begin : CREDIT_TRACK
+            // A slot can be taken and returned in the same cycle; the
+            // counter moves by the net difference.
             always_ff @(posedge clk) begin
                 if (rst) begin
-                    credit_cnt[p] <= FIFO_DEPTH[CREDIT_W-1:0];
+                    slot_cnt[p] <= FIFO_DEPTH[CREDIT_W-1:0];
                 end else begin
-                    case ({downstream_credit[p], outq_credit_return[p]})
-                        2'b10: credit_cnt[p] <= credit_cnt[p] - 1; // packet received
-                        2'b01: credit_cnt[p] <= credit_cnt[p] + 1; // packet sent
-                        default: ; // no change or simultaneous
-                    endcase
+                    slot_cnt[p] <= slot_cnt[p]
+                                 + CREDIT_W'(outq_credit_return[p])
+                                 - CREDIT_W'(outq_credit_take[p]);
+                end
+            end
+
+            assign credit_avail[p] = (slot_cnt[p] != 0);
+
+            // One downstream credit per packet sent on the link, returned
+            // when the next router frees the buffer slot
+            always_ff @(posedge clk) begin
+                if (rst) begin
+                    credit_cnt[p] <= DOWNSTREAM_DEPTH[DS_W-1:0];
+                end else begin
+                    credit_cnt[p] <= credit_cnt[p]
+                                   + DS_W'(downstream_credit[p])
+                                   - DS_W'(outq_credit_return[p]);
                 end
             end
 
@@ -42,8 +63,4 @@ module credit_manager #(
         end
     endgenerate
 
-    // Upstream credit return
-    // (One credit per packet that leaves this router)
-    assign upstream_credit = outq_credit_return;
-
 endmodule
@@ -3,7 +3,9 @@ module input_port #(
     parameter int PACKET_WIDTH = 128,
     parameter int FIFO_DEPTH  = 8,
     parameter int COORD_W     = 4,
-    parameter int COORD_L_W   = 2
+    parameter int COORD_L_W   = 2,
+    parameter bit MULTICAST   = 1'b1,  // fork header-encoded multicast packets
+    parameter bit CLK_GATE    = 1'b0
 )(
     input  logic                    clk,
     input  logic                    rst,
@@ -20,16 +22,25 @@ module input_port #(
     input  logic [PACKET_WIDTH-1:0] in_packet,
     output logic                    in_ready,
 
+    // One credit back to the upstream router per packet that has left
+    // this input's buffers
+    output logic                    upstream_credit,
+
     output logic [NUM_PORTS-1:0]                    fifo_empty,
     output logic [PACKET_WIDTH-1:0]                 fifo_rd_data [NUM_PORTS],
-    input  logic [NUM_PORTS-1:0]                    fifo_rd_en
+    input  logic [NUM_PORTS-1:0]                    fifo_rd_en,
+
+    // Multicast fork slot: outputs it still needs, and the held packet
+    output logic [NUM_PORTS-1:0]                    mc_req,
+    output logic [PACKET_WIDTH-1:0]                 mc_rd_data,
+    input  logic [NUM_PORTS-1:0]                    mc_grant
 );
 
     // -----------------------------
     // Extract destination fields
     // -----------------------------
     logic [COORD_W-1:0] dst_x, dst_y;
-    logic [COORD_L_W-1:0] dest_lx, dest_ly;
+    logic [COORD_L_W-1:0] dst_lx, dst_ly;
     logic [1:0] vc_class;
     logic [NUM_PORTS-1:0] req_port;
 
@@ -38,51 +49,88 @@ module input_port #(
     assign dst_lx = in_packet[PACKET_WIDTH-1-2*COORD_W -: COORD_L_W];
     assign dst_ly = in_packet[PACKET_WIDTH-1-2*COORD_W-COORD_L_W -: COORD_L_W];
     assign vc_class = in_packet[PACKET_WIDTH-1-2*COORD_W-2*COORD_L_W -: 2];
+
+    // Multicast: flag below vc_class, then the destination set as one bit
+    // per output port ('1 = broadcast). The set applies at the router whose
+    // coordinates are in the header, where it replaces route_compute. On
+    // the way there the packet is routed as unicast like any other, so it
+    // crosses each link once.
+    localparam int MC_MSB = PACKET_WIDTH-1-2*COORD_W-2*COORD_L_W-2;
+
+    logic at_dst;
+    logic is_mc;
+    logic [NUM_PORTS-1:0] in_mc_set;
+
+    assign at_dst    = (dst_x == cur_x) && (dst_y == cur_y) &&
+                       (dst_lx == cur_lx) && (dst_ly == cur_ly);
+    assign is_mc     = MULTICAST && in_packet[MC_MSB] && at_dst;
+    assign in_mc_set = in_packet[MC_MSB-1 -: NUM_PORTS] & link_up;
     // -----------------------------
     // Route computation
     // -----------------------------
+    // route_compute always resolves the full 12-port chiplet set; the
+    // router only wires up its first NUM_PORTS ports, and link_up for the
+    // rest is tied low so they are never requested.
+    localparam int RC_PORTS = 12;
+
+    logic [RC_PORTS-1:0] rc_link_up;
+    logic [RC_PORTS-1:0] rc_req_ports;
+
+    assign rc_link_up = RC_PORTS'(link_up);
+    assign req_port   = rc_req_ports[NUM_PORTS-1:0];
+
     logic [$clog2(NUM_PORTS)-1:0] dest_port;
     logic retry;
     route_compute #(
         .TILE_BITS(COORD_W),
         .LOCAL_BITS(COORD_L_W)
     ) rc (
-        .pkt_valid(in_valid),
-        .cur_tile_x(cur_x),
-        .cur_tile_y(cur_y),
+        .pkt_valid(in_valid && !is_mc),
+        .curr_tile_x(cur_x),
+        .curr_tile_y(cur_y),
         .curr_lx(cur_lx),
         .curr_ly(cur_ly),
-        .dst_tile_x(dst_x),
-        .dst_tile_y(dst_y),
-        .dest_lx(dest_lx),
-        .dest_ly(dest_ly),
+        .dest_tile_x(dst_x),
+        .dest_tile_y(dst_y),
+        .dest_lx(dst_lx),
+        .dest_ly(dst_ly),
         .vc_class(vc_class),
-        .link_up(link_up),
-        .req_port(req_port),
+        .link_up(rc_link_up),
+        .req_ports(rc_req_ports),
         .retry(retry)
     );
 
-    integer i;
-    always @(*) begin
-        index = '0;
-        for (i = 0; i < NUM_PORTS; i = i + 1) begin
-            if (req_port[i])
-                dest_port = i[$clog2(NUM_PORTS)-1:0];
+    integer r;
+    always_comb begin
+        dest_port = '0;
+        for (r = 0; r < NUM_PORTS; r = r + 1) begin
+            if (req_port[r])
+                dest_port = r[$clog2(NUM_PORTS)-1:0];
         end
     end
 
     // -----------------------------
     // VOQ FIFOs
     // -----------------------------
+    localparam int CNT_W = $clog2(FIFO_DEPTH) + 1;
+
     logic [NUM_PORTS-1:0] fifo_full;
     logic [NUM_PORTS-1:0] fifo_wr_en;
+    logic [NUM_PORTS-1:0] voq_empty;
+    logic [NUM_PORTS-1:0] voq_rd;
+    logic [CNT_W-1:0]     voq_count [NUM_PORTS];
+    logic [NUM_PORTS-1:0] mc_block;
+
+    // VOQs held back by the fork slot look empty to the arbiters
+    assign fifo_empty = voq_empty | mc_block;
 
     genvar i;
     generate
         for (i = 0; i < NUM_PORTS; i++) begin : VOQ
             packet_fifo #(
                 .PACKET_WIDTH(PACKET_WIDTH),
-                .DEPTH(FIFO_DEPTH)
+                .DEPTH(FIFO_DEPTH),
+                .CLK_GATE(CLK_GATE)
             ) fifo (
                 .clk     (clk),
                 .rst     (rst),
@@ -91,21 +139,145 @@ module input_port #(
                 .full    (fifo_full[i]),
                 .rd_en   (fifo_rd_en[i]),
                 .rd_data (fifo_rd_data[i]),
-                .empty   (fifo_empty[i])
+                .empty   (voq_empty[i]),
+                .head_data(),
+                .count   (voq_count[i])
             );
+
+            assign voq_rd[i] = fifo_rd_en[i] && !voq_empty[i];
         end
     endgenerate
 
+    // -----------------------------
+    // Multicast fork slot
+    // -----------------------------
+    // A multicast packet is held once, in a single-entry slot. It requests
+    // every target output; each output arbiter grants it independently
+    // (when that output has credits), and the slot is released once the
+    // last target has been granted. Targets whose link goes down while the
+    // packet waits are dropped from the set.
+    //
+    // Per-(input, output) order is kept without draining the VOQs first.
+    // On accept, mc_ahead[o] records how many packets are already queued
+    // for target o; it counts down as VOQ o is read, and the slot only
+    // requests o once it reaches zero. From then on VOQ o is blocked until
+    // o has been granted, so unicasts that arrive behind the packet leave
+    // behind it.
+    logic mc_busy;
+    logic mc_wr_en;
+    logic mc_release;
+
+    generate
+        if (MULTICAST) begin : MC
+            logic                    mc_valid;
+            logic                    mc_done;
+            logic [PACKET_WIDTH-1:0] mc_head;
+            logic [NUM_PORTS-1:0]    mc_served;
+            logic [NUM_PORTS-1:0]    mc_need;
+            logic [NUM_PORTS-1:0]    mc_head_of;
+            logic [CNT_W-1:0]        mc_ahead [NUM_PORTS];
+
+            // Targets still to be served, and those with nothing queued
+            // ahead of the packet
+            assign mc_need  = mc_valid ? (mc_head[MC_MSB-1 -: NUM_PORTS] & link_up & ~mc_served) : '0;
+            assign mc_req   = mc_need & mc_head_of;
+            assign mc_done  = mc_valid && ((mc_need & ~mc_grant) == '0);
+            assign mc_busy  = mc_valid;
+            assign mc_block = mc_req;
+            assign mc_release = mc_done;
+
+            always_ff @(posedge clk) begin
+                if (rst) begin
+                    mc_valid  <= 1'b0;
+                    mc_served <= '0;
+                end else if (mc_wr_en) begin
+                    mc_valid  <= 1'b1;
+                    mc_served <= '0;
+                end else if (mc_done) begin
+                    mc_valid  <= 1'b0;
+                end else begin
+                    mc_served <= mc_served | mc_grant;
+                end
+            end
+
+            always_ff @(posedge clk) begin
+                if (mc_wr_en)
+                    mc_head <= in_packet;
+            end
+
+            for (i = 0; i < NUM_PORTS; i++) begin : AHEAD
+                assign mc_head_of[i] = (mc_ahead[i] == '0);
+
+                always_ff @(posedge clk) begin
+                    if (rst)
+                        mc_ahead[i] <= '0;
+                    else if (mc_wr_en)
+                        mc_ahead[i] <= in_mc_set[i] ? voq_count[i] - CNT_W'(voq_rd[i]) : '0;
+                    else if (mc_ahead[i] != '0)
+                        mc_ahead[i] <= mc_ahead[i] - CNT_W'(voq_rd[i]);
+                end
+            end
+
+            // The crossbar reads a grant one cycle later, like the VOQs. The
+            // slot only takes a new packet the cycle after it is released,
+            // so mc_head still holds the granted packet then.
+            assign mc_rd_data = mc_head;
+        end else begin : NO_MC
+            assign mc_busy    = 1'b1;
+            assign mc_block   = '0;
+            assign mc_release = 1'b0;
+            assign mc_req     = '0;
+            assign mc_rd_data = '0;
+        end
+    endgenerate
+
+    // -----------------------------
+    // Upstream credits
+    // -----------------------------
+    // A VOQ read or the fork slot being released frees one buffer slot.
+    // Several can be freed in the same cycle, but the credit wire carries
+    // one per cycle, so the rest wait in credit_pend.
+    localparam int PEND_W = $clog2(FIFO_DEPTH + NUM_PORTS + 2);
+
+    logic [PEND_W-1:0] credit_freed;
+    logic [PEND_W-1:0] credit_total;
+    logic [PEND_W-1:0] credit_pend;
+
+    always_comb begin
+        credit_freed = PEND_W'(mc_release);
+        for (int v = 0; v < NUM_PORTS; v++)
+            credit_freed = credit_freed + PEND_W'(voq_rd[v]);
+    end
+
+    assign credit_total = credit_pend + credit_freed;
+
+    always_ff @(posedge clk) begin
+        if (rst) begin
+            credit_pend     <= '0;
+            upstream_credit <= 1'b0;
+        end else begin
+            credit_pend     <= credit_total - PEND_W'(credit_total != 0);
+            upstream_credit <= (credit_total != 0);
+        end
+    end
+
     // -----------------------------
     // Demux + backpressure
     // -----------------------------
-    integer p;
     always_comb begin
         fifo_wr_en = '0;
+        mc_wr_en   = 1'b0;
         in_ready   = 1'b0;
 
         if (in_valid) begin
-            if (!fifo_full[dest_port] && !retry) begin
+            if (is_mc) begin
+                // waits for a free slot; an empty set (all targets down)
+                // waits like a retry
+                if (!mc_busy && in_mc_set != '0) begin
+                    mc_wr_en = 1'b1;
+                    in_ready = 1'b1;
+                end
+            end else if (!fifo_full[dest_port] && !retry) begin
                 fifo_wr_en[dest_port] = 1'b1;
                 in_ready              = 1'b1;
             end
@@ -0,0 +1,15 @@
+// noc_router sources and lint waivers for Verilator. Pass with -F so the
+// paths resolve relative to this file:
+//   verilator -F rtl/noc_router.f --top-module noc_router ...
+-Wno-WIDTHEXPAND
+-Wno-WIDTHTRUNC
+-Wno-LATCH
+-Wno-UNOPTFLAT
+noc_router.v
+input_port.v
+route_compute.v
+packet_fifo.v
+output_queue.v
+output_arbiter.v
+credit_manager.v
+clock_gate.v
@@ -3,15 +3,17 @@ module noc_router #(
     parameter int PACKET_WIDTH = 128,
     parameter int FIFO_DEPTH  = 8,
     parameter int COORD_W     = 4,
-    parameter int COORD_L_W   = 2
+    parameter int COORD_L_W   = 2,
+    parameter bit MULTICAST   = 1'b1,  // fork header-encoded multicast packets
+    parameter bit CLK_GATE    = 1'b1   // gate idle VOQ / output queue clocks
 )(
     input  logic                        clk,
     input  logic                        rst,
 
     input  logic [COORD_W-1:0]          cur_x,
     input  logic [COORD_W-1:0]          cur_y,
-    input logic [COORD_W-1:0]           cur_lx,
-    input logic [COORD_W-1:0]           cur_ly,
+    input logic [COORD_L_W-1:0]         cur_lx,
+    input logic [COORD_L_W-1:0]         cur_ly,
     input logic [NUM_PORTS-1:0]         link_up,
 
     input  logic [NUM_PORTS-1:0]        in_valid,
@@ -23,7 +25,7 @@ module noc_router #(
     input  logic [NUM_PORTS-1:0]        out_ready,
 
     input  logic [NUM_PORTS-1:0]        downstream_credit, // credit from downstream routers
-    output logic [NUM_PORTS-1:0]        upstream_credit
+    output logic [NUM_PORTS-1:0]        upstream_credit    // input buffer slot freed, per input
 );
 
     // ------------------------------------------------------------
@@ -33,6 +35,11 @@ module noc_router #(
     logic [PACKET_WIDTH-1:0] fifo_data [NUM_PORTS][NUM_PORTS];
     logic [NUM_PORTS-1:0] fifo_rd_en   [NUM_PORTS];
 
+    // Multicast fork slots, [input][output]
+    logic [NUM_PORTS-1:0]    mc_req     [NUM_PORTS];
+    logic [PACKET_WIDTH-1:0] mc_data    [NUM_PORTS];
+    logic [NUM_PORTS-1:0]    mc_grant   [NUM_PORTS];
+
     genvar i;
     generate
         for (i = 0; i < NUM_PORTS; i++) begin : IN_PORTS
@@ -40,7 +47,10 @@ module noc_router #(
                 .NUM_PORTS(NUM_PORTS),
                 .PACKET_WIDTH(PACKET_WIDTH),
                 .FIFO_DEPTH(FIFO_DEPTH),
-                .COORD_W(COORD_W)
+                .COORD_W(COORD_W),
+                .COORD_L_W(COORD_L_W),
+                .MULTICAST(MULTICAST),
+                .CLK_GATE(CLK_GATE)
             ) ip (
                 .clk(clk),
                 .rst(rst),
@@ -52,28 +62,55 @@ module noc_router #(
                 .in_valid(in_valid[i]),
                 .in_packet(in_packet[i]),
                 .in_ready(in_ready[i]),
+                .upstream_credit(upstream_credit[i]),
                 .fifo_empty(fifo_empty[i]),
                 .fifo_rd_data(fifo_data[i]),
-                .fifo_rd_en(fifo_rd_en[i])
+                .fifo_rd_en(fifo_rd_en[i]),
+                .mc_req(mc_req[i]),
+                .mc_rd_data(mc_data[i]),
+                .mc_grant(mc_grant[i])
             );
         end
     endgenerate
 
     // Output arbiters
+    // Arbiter o sees column o of the VOQ status: [output][input]. With
+    // MULTICAST, inputs NUM_PORTS.. are the multicast fork slots that
+    // still need output o.
+    localparam int ARB_IN = MULTICAST ? 2 * NUM_PORTS : NUM_PORTS;
+
+    logic [ARB_IN-1:0] arb_fifo_empty [NUM_PORTS];
+    logic [ARB_IN-1:0] arb_rd_en      [NUM_PORTS];
     logic [NUM_PORTS-1:0] arb_grant_valid;
     logic [NUM_PORTS-1:0] can_send;
+    logic [NUM_PORTS-1:0] credit_avail;
+
+    genvar o, t;
+    generate
+        for (o = 0; o < NUM_PORTS; o++) begin : XBAR_T
+            for (t = 0; t < NUM_PORTS; t++) begin : XBAR_T_IN
+                assign arb_fifo_empty[o][t] = fifo_empty[t][o];
+                assign fifo_rd_en[t][o]     = arb_rd_en[o][t];
+                if (MULTICAST) begin : XBAR_T_MC
+                    assign arb_fifo_empty[o][NUM_PORTS+t] = ~mc_req[t][o];
+                    assign mc_grant[t][o]                 = arb_rd_en[o][NUM_PORTS+t];
+                end else begin : XBAR_T_NO_MC
+                    assign mc_grant[t][o] = 1'b0;
+                end
+            end
+        end
+    endgenerate
 
-    genvar o;
     generate
         for (o = 0; o < NUM_PORTS; o++) begin : ARBITERS
             output_arbiter #(
-                .NUM_INPUTS(NUM_PORTS)
+                .NUM_INPUTS(ARB_IN)
             ) arb (
                 .clk(clk),
                 .rst(rst),
-                .fifo_empty({fifo_empty[NUM_PORTS-1:0][o]}),
-                .outq_ready(can_send[o]),
-                .fifo_rd_en({fifo_rd_en[NUM_PORTS-1:0][o]}),
+                .fifo_empty(arb_fifo_empty[o]),
+                .outq_ready(credit_avail[o]),
+                .fifo_rd_en(arb_rd_en[o]),
                 .grant_valid(arb_grant_valid[o])
             );
         end
@@ -82,53 +119,93 @@ module noc_router #(
     // ------------------------------------------------------------
     // Pipeline register (FIFO read latency fix)
     // ------------------------------------------------------------
-    logic [PACKET_WIDTH-1:0] pipe_data [NUM_PORTS];
-    logic                    pipe_valid[NUM_PORTS];
+    // VOQ read data is registered, so a packet granted in cycle t shows
+    // up on fifo_data in cycle t+1. Register each grant and its input,
+    // then steer that VOQ output into the output queue.
+    localparam int SRC_W = (ARB_IN > 1) ? $clog2(ARB_IN) : 1;
+
+    // Crossbar sources per output: VOQs, then multicast fork slots
+    logic [PACKET_WIDTH-1:0] xbar_data [NUM_PORTS][ARB_IN];
+
+    logic [SRC_W-1:0]        grant_src  [NUM_PORTS];
+    logic [PACKET_WIDTH-1:0] pipe_data  [NUM_PORTS];
+    logic                    pipe_valid [NUM_PORTS];
+    logic [SRC_W-1:0]        pipe_src   [NUM_PORTS];
+
+    always_comb begin
+        for (int po = 0; po < NUM_PORTS; po++) begin
+            grant_src[po] = '0;
+            for (int pi = 0; pi < ARB_IN; pi++) begin
+                if (arb_rd_en[po][pi])
+                    grant_src[po] = pi[SRC_W-1:0];
+            end
+        end
+    end
 
-    integer pi, po;
     always_ff @(posedge clk) begin
         if (rst) begin
-            for (po = 0; po < NUM_PORTS; po++) begin
+            for (int po = 0; po < NUM_PORTS; po++) begin
                 pipe_valid[po] <= 1'b0;
+                pipe_src[po]   <= '0;
             end
         end else begin
-            for (po = 0; po < NUM_PORTS; po++) begin
+            for (int po = 0; po < NUM_PORTS; po++) begin
                 pipe_valid[po] <= arb_grant_valid[po];
-                for (pi = 0; pi < NUM_PORTS; pi++) begin
-                    if (fifo_rd_en[pi][po])
-                        pipe_data[po] <= fifo_data[pi][po];
-                end
+                if (arb_grant_valid[po])
+                    pipe_src[po] <= grant_src[po];
             end
         end
     end
 
+    generate
+        for (o = 0; o < NUM_PORTS; o++) begin : PIPE_MUX
+            for (t = 0; t < NUM_PORTS; t++) begin : SRC
+                assign xbar_data[o][t] = fifo_data[t][o];
+                if (MULTICAST) begin : SRC_MC
+                    assign xbar_data[o][NUM_PORTS+t] = mc_data[t];
+                end
+            end
+            assign pipe_data[o] = xbar_data[o][pipe_src[o]];
+        end
+    endgenerate
+
     // ------------------------------------------------------------
     // Output queues
     // ------------------------------------------------------------
     logic [NUM_PORTS-1:0] credit_return;
+    logic [NUM_PORTS-1:0] oq_valid;
 
     generate
         for (o = 0; o < NUM_PORTS; o++) begin : OUT_Q
             output_queue #(
                 .PACKET_WIDTH(PACKET_WIDTH),
-                .DEPTH(FIFO_DEPTH)
+                .DEPTH(FIFO_DEPTH),
+                .CLK_GATE(CLK_GATE)
             ) oq (
                 .clk(clk),
                 .rst(rst),
                 .enq_valid(pipe_valid[o]),
                 .enq_data(pipe_data[o]),
                 .enq_ready(), // already protected by credits
-                .out_valid(out_valid[o]),
+                .out_valid(oq_valid[o]),
                 .out_data(out_packet[o]),
-                .out_ready(out_ready[o]),
+                .out_ready(out_ready[o] & can_send[o]),
                 .credit_return(credit_return[o])
             );
+
+            // Only offer a packet when the next router has room for it
+            assign out_valid[o] = oq_valid[o] & can_send[o];
         end
     endgenerate
 
     // ------------------------------------------------------------
     // Credit manager
     // ------------------------------------------------------------
+    // One credit per output queue slot: taken when a packet is granted,
+    // returned when it leaves the queue. This covers packets still in the
+    // pipeline register, so the queue never overflows. Separately, each output holds one credit per buffer slot
+    // of the downstream router (can_send), spent when a packet leaves on
+    // the link and returned through downstream_credit.
     credit_manager #(
         .NUM_PORTS(NUM_PORTS),
         .FIFO_DEPTH(FIFO_DEPTH)
@@ -136,9 +213,10 @@ module noc_router #(
         .clk(clk),
         .rst(rst),
         .outq_credit_return(credit_return),
+        .outq_credit_take(arb_grant_valid),
         .downstream_credit(downstream_credit),
         .can_send(can_send),
-        .upstream_credit(upstream_credit)
+        .credit_avail(credit_avail)
     );
 
 endmodule
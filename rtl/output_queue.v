@@ -1,6 +1,7 @@
 module output_queue #(
     parameter int PACKET_WIDTH = 128,
-    parameter int DEPTH        = 8
+    parameter int DEPTH        = 8,
+    parameter bit CLK_GATE     = 1'b0
 )(
     input  logic                    clk,
     input  logic                    rst,
@@ -27,7 +28,8 @@ module output_queue #(
     // Instantiate packet FIFO
     packet_fifo #(
         .PACKET_WIDTH(PACKET_WIDTH),
-        .DEPTH(DEPTH)
+        .DEPTH(DEPTH),
+        .CLK_GATE(CLK_GATE)
     ) fifo (
         .clk     (clk),
         .rst     (rst),
@@ -35,8 +37,10 @@ module output_queue #(
         .wr_data (enq_data),
         .full    (fifo_full),
         .rd_en   (fifo_rd_en),
-        .rd_data (out_data),
-        .empty   (fifo_empty)
+        .rd_data (),
+        .empty   (fifo_empty),
+        .head_data(out_data),  // out_data is valid together with out_valid
+        .count   ()
     );
 
     // Enqueue logic
@@ -1,6 +1,7 @@
 module packet_fifo #(
     parameter int PACKET_WIDTH = 128,
-    parameter int DEPTH        = 8
+    parameter int DEPTH        = 8,
+    parameter bit CLK_GATE     = 1'b0
 )(
     input  logic                   clk,
     input  logic                   rst,
@@ -13,7 +14,13 @@ module packet_fifo #(
     // Read side
     input  logic                   rd_en,
     output logic [PACKET_WIDTH-1:0] rd_data,
-    output logic                   empty
+    output logic                   empty,
+
+    // Head of queue (first-word fall-through view)
+    output logic [PACKET_WIDTH-1:0] head_data,
+
+    // Packets currently held
+    output logic [$clog2(DEPTH):0]  count
 );
 
     localparam int ADDR_W = $clog2(DEPTH);
@@ -21,47 +28,57 @@ module packet_fifo #(
     logic [PACKET_WIDTH-1:0] mem [DEPTH];
     logic [ADDR_W:0]         wr_ptr;
     logic [ADDR_W:0]         rd_ptr;
-    logic [ADDR_W:0]         count;
 
     // Status flags
     assign full  = (count == DEPTH);
     assign empty = (count == 0);
 
+    // -----------------------------
+    // Clock gating
+    // -----------------------------
+    // The FIFO only needs a clock edge when it is written, read or reset;
+    // an idle queue keeps its state with the clock stopped.
+    logic fifo_clk;
+
+    generate
+        if (CLK_GATE) begin : GATE
+            clock_gate cg (
+                .clk     (clk),
+                .en      (rst | wr_en | rd_en),
+                .test_en (1'b0),
+                .gclk    (fifo_clk)
+            );
+        end else begin : NO_GATE
+            assign fifo_clk = clk;
+        end
+    endgenerate
+
+    assign head_data = mem[rd_ptr[ADDR_W-1:0]];
+
+    logic do_wr;
+    logic do_rd;
+
+    assign do_wr = wr_en && !full;
+    assign do_rd = rd_en && !empty;
+
     // Read data (registered)
-    always_ff @(posedge clk) begin
-        if (rd_en && !empty)
+    always_ff @(posedge fifo_clk) begin
+        if (do_rd)
             rd_data <= mem[rd_ptr[ADDR_W-1:0]];
     end
 
-    // Write / Read pointers and count
-    always_ff @(posedge clk) begin
+    // Write / Read pointers and count, only updated on a write or read
+    always_ff @(posedge fifo_clk) begin
         if (rst) begin
             wr_ptr <= '0;
             rd_ptr <= '0;
             count  <= '0;
-        end else begin
-            case ({wr_en && !full, rd_en && !empty})
-
-                2'b10: begin // write only
-                    mem[wr_ptr[ADDR_W-1:0]] <= wr_data;
-                    wr_ptr <= wr_ptr + 1;
-                    count  <= count + 1;
-                end
-
-                2'b01: begin // read only
-                    rd_ptr <= rd_ptr + 1;
-                    count  <= count - 1;
-                end
-
-                2'b11: begin // simultaneous read & write
-                    mem[wr_ptr[ADDR_W-1:0]] <= wr_data;
-                    wr_ptr <= wr_ptr + 1;
-                    rd_ptr <= rd_ptr + 1;
-                    // count unchanged
-                end
-
-                default: ; // no-op
-            endcase
+        end else if (do_wr || do_rd) begin
+            if (do_wr)
+                mem[wr_ptr[ADDR_W-1:0]] <= wr_data;
+            wr_ptr <= wr_ptr + {{ADDR_W{1'b0}}, do_wr};
+            rd_ptr <= rd_ptr + {{ADDR_W{1'b0}}, do_rd};
+            count  <= count + {{ADDR_W{1'b0}}, do_wr} - {{ADDR_W{1'b0}}, do_rd};
         end
     end
 
@@ -19,6 +19,19 @@ set ::DESIGN_NAME   route_compute
 set ::RTL_FILES     {route_compute.v}
 set ::SDC_FILE      /path/to/constraints.sdc
 
+# Switching activity for power analysis (empty to skip), e.g. a SAIF
+# from tb/noc_router/run_power.sh, and the design instance inside it
+set ::SAIF_FILE     ""
+set ::SAIF_INSTANCE TOP/$::DESIGN_NAME
+
+# Top-level parameter overrides, e.g. {{CLK_GATE 0}} for an ungated
+# noc_router; lp_insert_clock_gating follows CLK_GATE
+set ::PARAMETERS    {}
+
+# Library integrated clock-gating cell for rtl/clock_gate.v (CK/E/SE/GCK
+# pins); empty builds the generic latch + AND gate
+set ::ICG_CELL      ""
+
 set ::REPORT_DIR    reports
 set ::OUTPUT_DIR    outputs
 
@@ -51,6 +64,7 @@ puts "Hostname       : [info hostname]"
 puts "Design name    : $::DESIGN_NAME"
 puts "RTL files      : $::RTL_FILES"
 puts "SDC file       : $::SDC_FILE"
+puts "SAIF file      : $::SAIF_FILE"
 puts "Library path   : [get_db init_lib_search_path]"
 
 if {[file exists /proc/cpuinfo]} {
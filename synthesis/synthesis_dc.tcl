@@ -25,6 +25,21 @@ set my_input_delay_ns 0.1
 # Reserved time for output signals (holdtime, [SuperCHIPS] I/O, etc.)
 set my_output_delay_ns 0.1
 
+# Switching activity for power analysis (leave empty to skip)
+# e.g. ../vcd_saif/noc_router_gate1.saif from tb/noc_router/run_power.sh
+set my_saif_file ""
+# Instance of the top-level design inside the SAIF hierarchy
+set my_saif_instance TOP/TOP_MODULE_NAME_HERE
+
+# Top-level parameter overrides, e.g. "CLK_GATE=0" for an ungated noc_router.
+# compile_ultra -gate_clock follows CLK_GATE, so a CLK_GATE=0 netlist has no
+# clock gating at all and can be compared against the default CLK_GATE=1.
+set my_parameters ""
+
+# Library integrated clock-gating cell used by rtl/clock_gate.v (CK/E/SE/GCK
+# pins). Leave empty to build the generic latch + AND gate instead.
+set my_icg_cell ""
+
 
 # Setup Library Files
 set link_library   "/home/path/to/lib/tech.db"
@@ -49,8 +64,16 @@ set compile_seqmap_propagate_constants true
 
 
 # Analyze and elaboration
-analyze -f verilog $my_verilog_files
-elaborate $my_toplevel
+set my_defines [list SYNTHESIS]
+if { $my_icg_cell != "" } {
+    lappend my_defines ICG_CELL=$my_icg_cell
+}
+analyze -define $my_defines -f verilog $my_verilog_files
+if { $my_parameters != "" } {
+    elaborate $my_toplevel -parameters $my_parameters
+} else {
+    elaborate $my_toplevel
+}
 current_design $my_toplevel
 
 
@@ -116,11 +139,15 @@ set_output_delay $my_output_delay_ns -clock $clk_name [all_outputs]
 
 # Compile design
 # ------------------------------------------------------------------
-compile_ultra -no_autoungroup -timing_high_effort_script -gate_clock
+set my_compile_options [list -no_autoungroup -timing_high_effort_script]
+if { ![string match "*CLK_GATE=0*" $my_parameters] } {
+    lappend my_compile_options -gate_clock
+}
+eval compile_ultra $my_compile_options
 # ------------------------------------------------------------------
 # -no_autoungroup keeps hierarchy unless explicitly flattened
 # -timing_high_effort_script enables aggressive path restructuring
-# -gate_clock allows safe automatic clock gating insertion
+# -gate_clock allows safe automatic clock gating insertion (off for CLK_GATE=0)
 # ------------------------------------------------------------------
 
 # Other compile options (alternative flows)
@@ -150,13 +177,18 @@ redirect reports/cell.rep       { report_cell }
 redirect reports/area.rep       { report_area -hier }
 
 # For power analysis using DC it is strongly suggested to use switching activity files (SAIF)!
-# Convert your .vcd output to .siaf using this command:
+# Convert your .vcd output to .saif using either of these commands:
 # --------------------------------------------------------------------------------------------
 #                      vcd2saif -input file.vcd -output file.saif                            #
+#            vcd_saif/vcd_activity file.vcd --saif=file.saif (no Synopsys license)           #
 # --------------------------------------------------------------------------------------------
-# Then us the following commands to extract the saif-base power consuption:
-# read_saif -input file.saif -instance TOP_MODULE_NAME_HERE/uut
-# redirect reports/power_saif.rep { report_power -analysis_effort high -hier }
+# and set my_saif_file above. Energy per flit = total power x "time per flit" printed by
+# vcd_activity (see vcd_saif/*.activity.rpt).
+if { $my_saif_file != "" } {
+    read_saif -auto_map_names -input $my_saif_file -instance $my_saif_instance
+    redirect reports/power_saif.rep { report_power -analysis_effort high -hier }
+    redirect reports/saif_annotation.rep { report_saif -hier -missing }
+}
 
 redirect reports/power.rep      { report_power -hier }
 
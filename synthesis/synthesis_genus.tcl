@@ -5,8 +5,16 @@
 
 puts "\n========== Synthesis started =========="
 
-read_hdl $::RTL_FILES
-elaborate
+set hdl_defines [list SYNTHESIS]
+if {$::ICG_CELL != ""} {
+  lappend hdl_defines ICG_CELL=$::ICG_CELL
+}
+read_hdl -define $hdl_defines $::RTL_FILES
+if {[llength $::PARAMETERS] > 0} {
+  elaborate -parameters $::PARAMETERS $::DESIGN_NAME
+} else {
+  elaborate $::DESIGN_NAME
+}
 timestat Elaboration
 # Check for unresolved refs & empty modules
 check_design -unresolved   
@@ -20,6 +28,18 @@ read_sdc $::SDC_FILE
 # set_output_delay -clock ${clkpin} 0 [vfind /designs/${DESIGN}/ports -port *]
 # dc::set_clock_transition .1 ${clkpin}
 
+# Insert clock gating on enable-style registers, unless this is the ungated
+# CLK_GATE=0 reference
+set clk_gate 1
+foreach param $::PARAMETERS {
+  if {[lindex $param 0] == "CLK_GATE"} {
+    set clk_gate [lindex $param 1]
+  }
+}
+if {$clk_gate != 0} {
+  set_db lp_insert_clock_gating true
+}
+
 # Effort levels
 set_db syn_generic_effort high
 set_db syn_map_effort     high
@@ -40,6 +60,12 @@ report_timing -lint
 
 report_timing -unconstrained > $::REPORT_DIR/report_timing.rpt
 report_power                 > $::REPORT_DIR/report_power.rpt
+
+# Activity-annotated power (SAIF from vcd_saif/vcd_activity or vcd2saif)
+if {[info exists ::SAIF_FILE] && $::SAIF_FILE != ""} {
+  read_activity_file -format SAIF -scope $::SAIF_INSTANCE $::SAIF_FILE
+  report_power               > $::REPORT_DIR/report_power_saif.rpt
+}
 report_area                  > $::REPORT_DIR/report_area.rpt
 report_qor                   > $::REPORT_DIR/report_qor.rpt
 report datapath              > $::REPORT_DIR/report_datapath.rpt
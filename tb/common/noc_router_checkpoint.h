@@ -0,0 +1,164 @@
+#ifndef NOC_ROUTER_CHECKPOINT_H
+#define NOC_ROUTER_CHECKPOINT_H
+
+// Checkpoint / restore for NocRouterHarness.
+//
+// A checkpoint holds the full Verilated model state (requires verilator
+// --savable) together with everything the harness needs to continue the
+// run bit-identically: cycle and trace time, PRNG, traffic configuration,
+// source queues, scoreboard and statistics.
+
+#include <deque>
+#include <string>
+#include <verilated_save.h>
+#include "noc_router_harness.h"
+
+#define CKPT_MAGIC   0x4E4F4343u // "NOCC"
+#define CKPT_VERSION 1u
+
+// Build parameters a checkpoint depends on, written after magic/version and
+// compared on restore: the router parameters the harness was compiled for
+// (which must match the -G overrides of the model), harness constants, and
+// the sizes of the structs written raw below.
+#define CKPT_NUM_PARAMS 12
+
+static const char* const CKPT_PARAM_NAMES[CKPT_NUM_PARAMS] = {
+    "NUM_PORTS", "PACKET_WIDTH", "FIFO_DEPTH", "COORD_W", "COORD_L_W", "MULTICAST",
+    "CLK_GATE", "CLK_PERIOD_PS", "CUR_TILE", "CUR_LOCAL", "sizeof(TrafficConfig)", "sizeof(Flit)",
+};
+
+static inline void ckpt_params(int32_t p[CKPT_NUM_PARAMS]) {
+    const int32_t v[CKPT_NUM_PARAMS] = {
+        NUM_PORTS, PACKET_WIDTH, FIFO_DEPTH, COORD_W, COORD_L_W, MULTICAST,
+        CLK_GATE, CLK_PERIOD_PS, CUR_TILE, CUR_LOCAL,
+        (int32_t)sizeof(TrafficConfig), (int32_t)sizeof(Flit),
+    };
+    for (int i = 0; i < CKPT_NUM_PARAMS; i++) p[i] = v[i];
+}
+
+template <typename T>
+static inline void ckpt_put(VerilatedSerialize& os, const T& v) {
+    os.write(&v, sizeof(v));
+}
+
+template <typename T>
+static inline void ckpt_get(VerilatedDeserialize& is, T& v) {
+    is.read(&v, sizeof(v));
+}
+
+template <typename T>
+static inline void ckpt_put(VerilatedSerialize& os, const std::deque<T>& q) {
+    uint64_t n = q.size();
+    ckpt_put(os, n);
+    for (const T& v : q) ckpt_put(os, v);
+}
+
+template <typename T>
+static inline void ckpt_get(VerilatedDeserialize& is, std::deque<T>& q) {
+    uint64_t n = 0;
+    ckpt_get(is, n);
+    q.clear();
+    for (uint64_t i = 0; i < n; i++) {
+        T v;
+        ckpt_get(is, v);
+        q.push_back(v);
+    }
+}
+
+static inline bool save_checkpoint(NocRouterHarness& tb, const std::string& path) {
+    VerilatedSave os;
+    os.open(path.c_str());
+    if (!os.isOpen()) {
+        printf("FAIL: cannot write checkpoint %s\n", path.c_str());
+        return false;
+    }
+
+    // Header: checkpoints only restore into an identically built model
+    ckpt_put(os, (uint32_t)CKPT_MAGIC);
+    ckpt_put(os, (uint32_t)CKPT_VERSION);
+    int32_t params[CKPT_NUM_PARAMS];
+    ckpt_params(params);
+    for (int i = 0; i < CKPT_NUM_PARAMS; i++) ckpt_put(os, params[i]);
+
+    ckpt_put(os, tb.sim_time);
+    ckpt_put(os, tb.cycle);
+    ckpt_put(os, tb.rng.s);
+    ckpt_put(os, tb.traffic);
+    for (int i = 0; i < NUM_PORTS; i++) {
+        ckpt_put(os, tb.next_seq[i]);
+        ckpt_put(os, tb.src_q[i]);
+        for (int o = 0; o < NUM_PORTS; o++) ckpt_put(os, tb.expect[i][o]);
+    }
+    ckpt_put(os, tb.credit_pipe);
+    ckpt_put(os, tb.sink_fill);
+    ckpt_put(os, tb.measure_from);
+    ckpt_put(os, tb.messages);
+    ckpt_put(os, tb.link_flits);
+    ckpt_put(os, tb.injected);
+    ckpt_put(os, tb.delivered);
+    ckpt_put(os, tb.latency_sum);
+    ckpt_put(os, tb.latency_max);
+    ckpt_put(os, tb.latency_cnt);
+    ckpt_put(os, tb.errors);
+
+    os << *tb.dut;
+    os.close();
+    return true;
+}
+
+static inline bool restore_checkpoint(NocRouterHarness& tb, const std::string& path) {
+    VerilatedRestore is;
+    is.open(path.c_str());
+    if (!is.isOpen()) {
+        printf("FAIL: cannot read checkpoint %s\n", path.c_str());
+        return false;
+    }
+
+    uint32_t magic = 0, version = 0;
+    ckpt_get(is, magic);
+    ckpt_get(is, version);
+    if (magic != CKPT_MAGIC || version != CKPT_VERSION) {
+        printf("FAIL: %s is not a version %u noc_router checkpoint\n", path.c_str(), CKPT_VERSION);
+        return false;
+    }
+    int32_t params[CKPT_NUM_PARAMS];
+    ckpt_params(params);
+    bool match = true;
+    for (int i = 0; i < CKPT_NUM_PARAMS; i++) {
+        int32_t saved = 0;
+        ckpt_get(is, saved);
+        if (saved != params[i]) {
+            printf("FAIL: checkpoint built with %s=%d, this build has %d\n",
+                   CKPT_PARAM_NAMES[i], saved, params[i]);
+            match = false;
+        }
+    }
+    if (!match) return false;
+
+    ckpt_get(is, tb.sim_time);
+    ckpt_get(is, tb.cycle);
+    ckpt_get(is, tb.rng.s);
+    ckpt_get(is, tb.traffic);
+    for (int i = 0; i < NUM_PORTS; i++) {
+        ckpt_get(is, tb.next_seq[i]);
+        ckpt_get(is, tb.src_q[i]);
+        for (int o = 0; o < NUM_PORTS; o++) ckpt_get(is, tb.expect[i][o]);
+    }
+    ckpt_get(is, tb.credit_pipe);
+    ckpt_get(is, tb.sink_fill);
+    ckpt_get(is, tb.measure_from);
+    ckpt_get(is, tb.messages);
+    ckpt_get(is, tb.link_flits);
+    ckpt_get(is, tb.injected);
+    ckpt_get(is, tb.delivered);
+    ckpt_get(is, tb.latency_sum);
+    ckpt_get(is, tb.latency_max);
+    ckpt_get(is, tb.latency_cnt);
+    ckpt_get(is, tb.errors);
+
+    is >> *tb.dut;
+    is.close();
+    return true;
+}
+
+#endif
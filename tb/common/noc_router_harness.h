@@ -0,0 +1,580 @@
+#ifndef NOC_ROUTER_HARNESS_H
+#define NOC_ROUTER_HARNESS_H
+
+// Shared C++ test environment for noc_router.
+//
+// Drives per-input source queues with synthetic traffic, sinks every output,
+// and checks delivered packets against a per-(src,dst) scoreboard. Router
+// parameters must match the Verilated model; override them with
+// -CFLAGS "-DNUM_PORTS=... -DPACKET_WIDTH=..." alongside -G on verilator.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <verilated.h>
+#include <verilated_vcd_c.h>
+#include "Vnoc_router.h"
+
+#ifndef NUM_PORTS
+#define NUM_PORTS 5
+#endif
+#ifndef PACKET_WIDTH
+#define PACKET_WIDTH 128
+#endif
+#ifndef FIFO_DEPTH
+#define FIFO_DEPTH 8
+#endif
+#ifndef COORD_W
+#define COORD_W 4
+#endif
+#ifndef COORD_L_W
+#define COORD_L_W 2
+#endif
+// Defaults of the noc_router parameters of the same name; only recorded
+// (in checkpoints), pass them with -D when building with -G overrides
+#ifndef MULTICAST
+#define MULTICAST 1
+#endif
+#ifndef CLK_GATE
+#define CLK_GATE 1
+#endif
+// Clock period used for VCD timestamps (ps). Matches my_clk_freq_MHz in
+// synthesis/synthesis_dc.tcl so SAIF durations line up with the constraints.
+#ifndef CLK_PERIOD_PS
+#define CLK_PERIOD_PS 1000
+#endif
+
+#define PKT_WORDS ((PACKET_WIDTH + 31) / 32)
+
+// Payload layout (below the routing header)
+#define PKT_SEQ_LSB 0
+#define PKT_SEQ_W   32
+#define PKT_SRC_LSB 32
+#define PKT_SRC_W   8
+
+// Multicast flag, directly below vc_class; the destination set (one bit
+// per output port) sits below it
+#define PKT_MC_BIT (PACKET_WIDTH - 1 - 2 * COORD_W - 2 * COORD_L_W - 2)
+
+static_assert(PACKET_WIDTH >= PKT_SRC_LSB + PKT_SRC_W + 2 * COORD_W + 2 * COORD_L_W + 3 + NUM_PORTS,
+              "PACKET_WIDTH too small for harness header + payload");
+
+// Router position used by the harness: tile (1,1), local (1,1). Every
+// route_compute port is then reachable by picking a neighbouring coordinate.
+#define CUR_TILE  1
+#define CUR_LOCAL 1
+
+// Destination {tile_x, tile_y, lx, ly} that makes route_compute pick port p
+static const int PORT_DST[12][4] = {
+    {1, 1, 1, 2}, // N
+    {1, 1, 1, 0}, // S
+    {1, 1, 2, 1}, // E
+    {1, 1, 0, 1}, // W
+    {1, 1, 2, 2}, // NE
+    {1, 1, 0, 2}, // NW
+    {1, 1, 2, 0}, // SE
+    {1, 1, 0, 0}, // SW
+    {1, 2, 1, 1}, // SER_N
+    {1, 0, 1, 1}, // SER_S
+    {2, 1, 1, 1}, // SER_E
+    {0, 1, 1, 1}, // SER_W
+};
+
+// -----------------------------
+// Command line helpers
+// -----------------------------
+// Options are passed as --key=value
+static inline const char* tb_arg(int argc, char** argv, const char* key) {
+    size_t n = strlen(key);
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strncmp(a, "--", 2) == 0 && strncmp(a + 2, key, n) == 0 && a[2 + n] == '=')
+            return a + 3 + n;
+    }
+    return nullptr;
+}
+
+static inline long tb_arg_int(int argc, char** argv, const char* key, long def) {
+    const char* v = tb_arg(argc, argv, key);
+    return v ? strtol(v, nullptr, 0) : def;
+}
+
+static inline double tb_arg_double(int argc, char** argv, const char* key, double def) {
+    const char* v = tb_arg(argc, argv, key);
+    return v ? strtod(v, nullptr) : def;
+}
+
+// -----------------------------
+// Packet encoding
+// -----------------------------
+struct Packet {
+    uint32_t w[PKT_WORDS];
+};
+
+static inline void pkt_set(Packet& p, int lsb, int width, uint32_t val) {
+    for (int b = 0; b < width; b++) {
+        int bit = lsb + b;
+        uint32_t mask = 1u << (bit % 32);
+        if ((val >> b) & 1) p.w[bit / 32] |= mask;
+        else                p.w[bit / 32] &= ~mask;
+    }
+}
+
+static inline uint32_t pkt_get(const Packet& p, int lsb, int width) {
+    uint32_t val = 0;
+    for (int b = 0; b < width; b++) {
+        int bit = lsb + b;
+        val |= ((p.w[bit / 32] >> (bit % 32)) & 1u) << b;
+    }
+    return val;
+}
+
+// Header fields, MSB first: dst_x, dst_y, dst_lx, dst_ly, vc_class,
+// multicast flag, multicast destination set. A nonzero mc_set makes a
+// multicast packet, forked by the router at dst over the outputs in the set.
+static inline Packet make_packet_at(const int dst[4], int src_port, uint32_t seq, int vc = 0,
+                                    uint32_t mc_set = 0) {
+    Packet p;
+    memset(&p, 0, sizeof(p));
+    int msb = PACKET_WIDTH - 1;
+    pkt_set(p, msb - COORD_W + 1,   COORD_W,   dst[0]); msb -= COORD_W;
+    pkt_set(p, msb - COORD_W + 1,   COORD_W,   dst[1]); msb -= COORD_W;
+    pkt_set(p, msb - COORD_L_W + 1, COORD_L_W, dst[2]); msb -= COORD_L_W;
+    pkt_set(p, msb - COORD_L_W + 1, COORD_L_W, dst[3]); msb -= COORD_L_W;
+    pkt_set(p, msb - 1,             2,         vc);
+    if (mc_set) {
+        pkt_set(p, PKT_MC_BIT, 1, 1);
+        pkt_set(p, PKT_MC_BIT - NUM_PORTS, NUM_PORTS, mc_set);
+    }
+    pkt_set(p, PKT_SEQ_LSB, PKT_SEQ_W, seq);
+    pkt_set(p, PKT_SRC_LSB, PKT_SRC_W, src_port);
+    return p;
+}
+
+// Packet for output dst_port of the harness router; a multicast is forked
+// by this router, so its header carries the router's own coordinates
+static inline Packet make_packet(int dst_port, int src_port, uint32_t seq, int vc = 0,
+                                 uint32_t mc_set = 0) {
+    static const int here[4] = {CUR_TILE, CUR_TILE, CUR_LOCAL, CUR_LOCAL};
+    return make_packet_at(mc_set ? here : PORT_DST[dst_port], src_port, seq, vc, mc_set);
+}
+
+// Multicast destination set of a packet, 0 for unicast
+static inline uint32_t pkt_mc_set(const Packet& p) {
+    if (!pkt_get(p, PKT_MC_BIT, 1)) return 0;
+    return pkt_get(p, PKT_MC_BIT - NUM_PORTS, NUM_PORTS);
+}
+
+// Copy between Packet and the Verilated port type (QData up to 64 bits,
+// VlWide above that)
+static inline void to_model(QData& dst, const Packet& p) {
+    dst = ((QData)p.w[1] << 32) | p.w[0];
+}
+template <std::size_t N>
+static inline void to_model(VlWide<N>& dst, const Packet& p) {
+    for (std::size_t i = 0; i < N; i++) dst[i] = p.w[i];
+}
+static inline void from_model(Packet& p, const QData& src) {
+    p.w[0] = (uint32_t)src;
+    p.w[1] = (uint32_t)(src >> 32);
+}
+template <std::size_t N>
+static inline void from_model(Packet& p, const VlWide<N>& src) {
+    for (std::size_t i = 0; i < N; i++) p.w[i] = src[i];
+}
+
+// -----------------------------
+// PRNG
+// -----------------------------
+// xorshift64: one word of state, so runs are reproducible from a seed
+struct XorShift64 {
+    uint64_t s;
+    explicit XorShift64(uint64_t seed = 1) : s(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+    uint64_t next() { s ^= s << 13; s ^= s >> 7; s ^= s << 17; return s; }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    int below(int n) { return (int)(next() % (uint64_t)n); }
+};
+
+// -----------------------------
+// Traffic generator
+// -----------------------------
+enum TrafficPattern {
+    TRAFFIC_UNIFORM,  // destination uniform over all outputs
+    TRAFFIC_HOTSPOT,  // hotspot_frac of packets go to hotspot_port
+    TRAFFIC_SHIFT     // input i always sends to output (i+1) % NUM_PORTS
+};
+
+static inline TrafficPattern parse_pattern(const char* s) {
+    if (s && strcmp(s, "hotspot") == 0) return TRAFFIC_HOTSPOT;
+    if (s && strcmp(s, "shift") == 0)   return TRAFFIC_SHIFT;
+    return TRAFFIC_UNIFORM;
+}
+
+struct Flit {
+    int      src;
+    int      dst;
+    uint32_t seq;
+    uint64_t inject_cycle;
+    uint32_t mc_set;   // multicast destination set, 0 for unicast
+};
+
+struct TrafficConfig {
+    TrafficPattern pattern = TRAFFIC_UNIFORM;
+    double rate = 0.1;         // packets per input per cycle
+    int hotspot_port = 0;
+    double hotspot_frac = 0.5;
+    double mc_frac = 0.0;      // fraction of messages that are multicast
+    int mc_fanout = 2;         // targets per multicast (never the source port)
+    bool mc_emulate = false;   // send each multicast as one unicast per target
+    int credit_delay = 2;      // cycles until a sink's credit reaches the router
+    double sink_rate = 1.0;    // packets per cycle each downstream buffer forwards
+};
+
+class NocRouterHarness {
+public:
+    Vnoc_router* dut;
+    VerilatedVcdC* tfp;
+    vluint64_t sim_time;
+    uint64_t cycle;
+    XorShift64 rng;
+    TrafficConfig traffic;
+
+    // Source queues and per-(src,dst) in-order scoreboard; each multicast
+    // copy is expected in order with the unicasts from the same source
+    std::deque<Flit> src_q[NUM_PORTS];
+    std::deque<Flit> expect[NUM_PORTS][NUM_PORTS];
+    uint32_t next_seq[NUM_PORTS];
+
+    // Downstream credits in flight back to the router, one port mask per
+    // cycle (traffic.credit_delay entries, sized at reset)
+    std::deque<uint32_t> credit_pipe;
+    // Packets held in each downstream buffer (FIFO_DEPTH slots)
+    int sink_fill[NUM_PORTS];
+
+    // Statistics (measurement window starts at measure_from)
+    uint64_t measure_from;
+    uint64_t messages;     // generated messages, a multicast counts once
+    uint64_t link_flits;   // packets accepted on the input links
+    uint64_t injected;
+    uint64_t delivered;
+    uint64_t latency_sum;
+    uint64_t latency_max;
+    uint64_t latency_cnt;
+    int errors;
+
+    explicit NocRouterHarness(uint64_t seed = 1) : rng(seed) {
+        dut = new Vnoc_router;
+        tfp = nullptr;
+        sim_time = 0;
+        cycle = 0;
+        for (int i = 0; i < NUM_PORTS; i++) next_seq[i] = 0;
+        for (int o = 0; o < NUM_PORTS; o++) sink_fill[o] = 0;
+        credit_pipe.assign(traffic.credit_delay, 0);
+        clear_stats();
+        errors = 0;
+    }
+
+    ~NocRouterHarness() {
+#if VM_TRACE
+        if (tfp) {
+            tfp->close();
+            delete tfp;
+        }
+#endif
+        dut->final();
+        delete dut;
+    }
+
+    // Needs a model built with --trace (VM_TRACE); the DSE builds without
+    void trace_open(const char* path) {
+#if VM_TRACE
+        Verilated::traceEverOn(true);
+        tfp = new VerilatedVcdC;
+        dut->trace(tfp, 99);
+        tfp->open(path);
+#else
+        printf("FAIL: model built without --trace, cannot write %s\n", path);
+        errors++;
+#endif
+    }
+
+    void clear_stats() {
+        measure_from = cycle;
+        messages = 0;
+        link_flits = 0;
+        injected = 0;
+        delivered = 0;
+        latency_sum = 0;
+        latency_max = 0;
+        latency_cnt = 0;
+    }
+
+    void init_inputs() {
+        dut->clk = 0;
+        dut->rst = 1;
+        dut->cur_x = CUR_TILE;
+        dut->cur_y = CUR_TILE;
+        dut->cur_lx = CUR_LOCAL;
+        dut->cur_ly = CUR_LOCAL;
+        dut->link_up = (1u << NUM_PORTS) - 1;
+        dut->in_valid = 0;
+        dut->out_ready = 0;
+        dut->downstream_credit = 0;
+        dut->eval();
+    }
+
+    void apply_reset() {
+        init_inputs();
+        credit_pipe.assign(traffic.credit_delay > 0 ? traffic.credit_delay : 1, 0);
+        for (int o = 0; o < NUM_PORTS; o++) sink_fill[o] = 0;
+        for (int i = 0; i < 3; i++) half_cycles();
+        dut->rst = 0;
+        dut->eval();
+    }
+
+    // Pick a destination for a new packet from input src
+    int pick_dst(int src) {
+        switch (traffic.pattern) {
+        case TRAFFIC_HOTSPOT:
+            if (rng.uniform() < traffic.hotspot_frac) return traffic.hotspot_port;
+            return rng.below(NUM_PORTS);
+        case TRAFFIC_SHIFT:
+            return (src + 1) % NUM_PORTS;
+        default:
+            return rng.below(NUM_PORTS);
+        }
+    }
+
+    // Pick mc_fanout distinct targets other than src
+    uint32_t pick_mc_set(int src) {
+        int k = traffic.mc_fanout < NUM_PORTS - 1 ? traffic.mc_fanout : NUM_PORTS - 1;
+        uint32_t set = 0;
+        for (int n = 0; n < k;) {
+            int o = rng.below(NUM_PORTS);
+            if (o != src && !((set >> o) & 1)) {
+                set |= 1u << o;
+                n++;
+            }
+        }
+        return set;
+    }
+
+    void push_flit(int src, int dst, uint32_t mc_set) {
+        Flit f;
+        f.src = src;
+        f.dst = dst;
+        f.seq = next_seq[src]++;
+        f.inject_cycle = cycle;
+        f.mc_set = mc_set;
+        src_q[src].push_back(f);
+        injected++;
+    }
+
+    void generate() {
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (rng.uniform() < traffic.rate) {
+                messages++;
+                if (traffic.mc_frac > 0 && rng.uniform() < traffic.mc_frac) {
+                    uint32_t set = pick_mc_set(i);
+                    if (!traffic.mc_emulate) {
+                        push_flit(i, __builtin_ctz(set), set);
+                    } else {
+                        for (int o = 0; o < NUM_PORTS; o++)
+                            if ((set >> o) & 1) push_flit(i, o, 0);
+                    }
+                } else {
+                    push_flit(i, pick_dst(i), 0);
+                }
+            }
+        }
+    }
+
+    // One clock cycle: drive inputs, sample handshakes, rising edge
+    void tick() {
+        generate();
+
+        uint32_t valid = 0;
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (!src_q[i].empty()) {
+                const Flit& f = src_q[i].front();
+                to_model(dut->in_packet[i], make_packet(f.dst, f.src, f.seq, 0, f.mc_set));
+                valid |= 1u << i;
+            }
+        }
+        dut->in_valid = valid;
+        // Sinks are always ready; the router only sends with a credit, and
+        // each downstream buffer returns it credit_delay cycles after
+        // forwarding the packet
+        dut->out_ready = (1u << NUM_PORTS) - 1;
+        dut->downstream_credit = credit_pipe.front();
+
+        dut->clk = 0;
+        dut->eval();
+        dump();
+
+        uint32_t accepted = dut->in_valid & dut->in_ready;
+        uint32_t fired = dut->out_valid & dut->out_ready;
+        for (int o = 0; o < NUM_PORTS; o++) {
+            if ((fired >> o) & 1) {
+                Packet p;
+                from_model(p, dut->out_packet[o]);
+                score(o, p);
+            }
+        }
+        credit_pipe.pop_front();
+        credit_pipe.push_back(sink_forward(fired));
+
+        dut->clk = 1;
+        dut->eval();
+        dump();
+
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if ((accepted >> i) & 1) {
+                const Flit& f = src_q[i].front();
+                if (f.mc_set) {
+                    // one copy per target whose link is up
+                    uint32_t set = f.mc_set & dut->link_up;
+                    for (int o = 0; o < NUM_PORTS; o++)
+                        if ((set >> o) & 1) expect[i][o].push_back(f);
+                } else {
+                    expect[i][f.dst].push_back(f);
+                }
+                link_flits++;
+                src_q[i].pop_front();
+            }
+        }
+        cycle++;
+    }
+
+    // Downstream buffers take what the router sent and forward up to
+    // sink_rate packets per cycle; returns the ports that freed a slot
+    uint32_t sink_forward(uint32_t fired) {
+        uint32_t freed = 0;
+        for (int o = 0; o < NUM_PORTS; o++) {
+            if ((fired >> o) & 1) sink_fill[o]++;
+            if (sink_fill[o] > FIFO_DEPTH) {
+                errors++;
+                printf("FAIL cycle %llu: output %d sent without a downstream credit\n",
+                       (unsigned long long)cycle, o);
+                sink_fill[o] = FIFO_DEPTH;
+            }
+            if (sink_fill[o] && (traffic.sink_rate >= 1.0 || rng.uniform() < traffic.sink_rate)) {
+                sink_fill[o]--;
+                freed |= 1u << o;
+            }
+        }
+        return freed;
+    }
+
+    void score(int out, const Packet& p) {
+        int src = pkt_get(p, PKT_SRC_LSB, PKT_SRC_W);
+        uint32_t seq = pkt_get(p, PKT_SEQ_LSB, PKT_SEQ_W);
+        bool mc = pkt_mc_set(p) != 0;
+        if (src >= NUM_PORTS || expect[src][out].empty()) {
+            errors++;
+            printf("FAIL cycle %llu: unexpected %spacket on output %d (src=%d seq=%u)\n",
+                   (unsigned long long)cycle, mc ? "multicast " : "", out, src, seq);
+            return;
+        }
+        std::deque<Flit>& q = expect[src][out];
+        const Flit& f = q.front();
+        if (f.seq != seq) {
+            errors++;
+            printf("FAIL cycle %llu: output %d src %d got seq %u expected %u\n",
+                   (unsigned long long)cycle, out, src, seq, f.seq);
+        }
+        delivered++;
+        if (f.inject_cycle >= measure_from) {
+            uint64_t lat = cycle - f.inject_cycle;
+            latency_sum += lat;
+            latency_cnt++;
+            if (lat > latency_max) latency_max = lat;
+        }
+        q.pop_front();
+    }
+
+    void run(uint64_t n) {
+        for (uint64_t c = 0; c < n; c++) tick();
+    }
+
+    bool idle() {
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (!src_q[i].empty()) return false;
+            for (int o = 0; o < NUM_PORTS; o++)
+                if (!expect[i][o].empty()) return false;
+        }
+        return true;
+    }
+
+    // Stop injecting and run until every packet has been delivered
+    bool drain(uint64_t max_cycles = 100000) {
+        double rate = traffic.rate;
+        traffic.rate = 0.0;
+        uint64_t c = 0;
+        while (!idle() && c++ < max_cycles) tick();
+        traffic.rate = rate;
+        if (!idle()) {
+            errors++;
+            printf("FAIL: router did not drain within %llu cycles\n", (unsigned long long)max_cycles);
+            return false;
+        }
+        return true;
+    }
+
+    // Standard measurement run: reset with traffic configuration cfg, warm
+    // up, measure `cycles`, then (drain_limit > 0) stop injecting and
+    // deliver the backlog so every packet is scored. Returns the accepted
+    // throughput of the measurement window; latency and the other
+    // statistics cover the window and the drain.
+    double run_window(const TrafficConfig& cfg, uint64_t warmup, uint64_t cycles,
+                      uint64_t drain_limit) {
+        traffic = cfg;
+        apply_reset();
+        run(warmup);
+        clear_stats();
+        run(cycles);
+        double thr = throughput();
+        if (drain_limit) drain(drain_limit);
+        return thr;
+    }
+
+    double avg_latency() const {
+        return latency_cnt ? (double)latency_sum / latency_cnt : 0.0;
+    }
+
+    // Accepted throughput in packets per output per cycle since clear_stats()
+    double throughput() const {
+        uint64_t window = cycle - measure_from;
+        return window ? (double)delivered / ((double)window * NUM_PORTS) : 0.0;
+    }
+
+    void report() {
+        printf("packets injected  %llu\n", (unsigned long long)injected);
+        printf("packets delivered %llu\n", (unsigned long long)delivered);
+        printf("avg latency       %.2f cycles\n", avg_latency());
+        printf("max latency       %llu cycles\n", (unsigned long long)latency_max);
+        printf("errors            %d\n", errors);
+    }
+
+private:
+    void half_cycles() {
+        dut->clk = 0;
+        dut->eval();
+        dump();
+        dut->clk = 1;
+        dut->eval();
+        dump();
+    }
+
+    void dump() {
+#if VM_TRACE
+        if (tfp) tfp->dump(sim_time);
+#endif
+        sim_time += CLK_PERIOD_PS / 2;
+    }
+};
+
+#endif
@@ -18,8 +18,10 @@ private:
     int passed;
     int failed;
 
-    // shadow credits for checking
+    // shadow credits for checking: downstream credits (can_send) and
+    // free output queue slots (credit_avail)
     int shadow_credit[NUM_PORTS];
+    int shadow_slot[NUM_PORTS];
 
 public:
     CreditManagerTB() {
@@ -35,6 +37,7 @@ public:
 
         for(int i = 0; i < NUM_PORTS; i++){
             shadow_credit[i] = FIFO_DEPTH;
+            shadow_slot[i] = FIFO_DEPTH;
         }
     }
 
@@ -55,13 +58,11 @@ public:
         // update shadow on posedge
         if(!dut->rst){
             for(int p = 0; p < NUM_PORTS; p++){
-                bool ds = (dut->downstream_credit >> p) & 1;
-                bool ret = (dut->outq_credit_return >> p) & 1;
-                if(ds && !ret){
-                    shadow_credit[p]--;
-                } else if(!ds && ret){
-                    shadow_credit[p]++;
-                }
+                int ds = (dut->downstream_credit >> p) & 1;
+                int sent = (dut->outq_credit_return >> p) & 1;
+                int take = (dut->outq_credit_take >> p) & 1;
+                shadow_credit[p] += ds - sent;
+                shadow_slot[p] += sent - take;
             }
         }
     }
@@ -69,6 +70,7 @@ public:
     void init_inputs() {
         dut->rst = 1;
         dut->outq_credit_return = 0;
+        dut->outq_credit_take = 0;
         dut->downstream_credit = 0;
         dut->eval();
     }
@@ -76,53 +78,71 @@ public:
     void apply_reset() {
         dut->rst = 1;
         dut->outq_credit_return = 0;
+        dut->outq_credit_take = 0;
         dut->downstream_credit = 0;
         tick(); tick();
         dut->rst = 0;
         tick();
-        for(int i = 0; i < NUM_PORTS; i++)
+        for(int i = 0; i < NUM_PORTS; i++){
             shadow_credit[i] = FIFO_DEPTH;
+            shadow_slot[i] = FIFO_DEPTH;
+        }
     }
 
     void wait_cycles(int n) {
         for(int i = 0; i < n; i++) tick();
     }
 
+    // packet sent downstream: spends a downstream credit
     void decrement_credit(int port) {
+        dut->outq_credit_return |= (1 << port);
+        tick();
+        dut->outq_credit_return &= ~(1 << port);
+    }
+    // credit returned by the downstream router
+    void increment_credit(int port) {
         dut->downstream_credit |= (1 << port);
         tick();
         dut->downstream_credit &= ~(1 << port);
     }
-    void increment_credit(int port) {
-        dut->outq_credit_return |= (1 << port);
+
+    // take/return an output queue slot on one port in a single cycle
+    void change_credit(int port, int take, int ret) {
+        dut->outq_credit_take = (uint32_t)take << port;
+        dut->outq_credit_return = (uint32_t)ret << port;
         tick();
-        dut->outq_credit_return &= ~(1 << port);
+        dut->outq_credit_take = 0;
+        dut->outq_credit_return = 0;
     }
 
-    bool check_can_send(int port, bool expected) {
+    int credit_avail(int port) {
+        return (dut->credit_avail >> port) & 1;
+    }
+
+    bool check_credit_avail(int port, int expected) {
         test_count++;
-        bool actual = (dut->can_send >> port) & 1;
+        int actual = credit_avail(port);
         if(actual == expected){ passed++; return true; }
         failed++;
-        printf("FAIL test %d: can_send[%d]=%d expected=%d\n", test_count, port, actual, expected);
+        printf("FAIL test %d: credit_avail[%d]=%d expected=%d\n", test_count, port, actual, expected);
         return false;
     }
 
-    bool check_all_can_send(uint8_t expected) {
+    bool check_can_send(int port, bool expected) {
         test_count++;
-        uint8_t actual = dut->can_send;
+        bool actual = (dut->can_send >> port) & 1;
         if(actual == expected){ passed++; return true; }
         failed++;
-        printf("FAIL test %d: can_send=0x%x expected=0x%x\n", test_count, actual, expected);
+        printf("FAIL test %d: can_send[%d]=%d expected=%d\n", test_count, port, actual, expected);
         return false;
     }
 
-    bool check_upstream_credit(uint8_t expected) {
+    bool check_all_can_send(uint8_t expected) {
         test_count++;
-        uint8_t actual = dut->upstream_credit;
+        uint8_t actual = dut->can_send;
         if(actual == expected){ passed++; return true; }
         failed++;
-        printf("FAIL test %d: upstream_credit=0x%x expected=0x%x\n", test_count, actual, expected);
+        printf("FAIL test %d: can_send=0x%x expected=0x%x\n", test_count, actual, expected);
         return false;
     }
 
@@ -165,21 +185,21 @@ public:
         apply_reset();
         for(int i = 0; i < 4; i++) decrement_credit(0);
         tick();
-        dut->downstream_credit = 1;
         dut->outq_credit_return = 1;
+        dut->downstream_credit = 1;
         tick();
-        dut->downstream_credit = 0;
         dut->outq_credit_return = 0;
+        dut->downstream_credit = 0;
         tick();
         check_can_send(0, true);
 
         // multi-port at once
         apply_reset();
-        dut->downstream_credit = 0b00011; // ports 0,1
-        dut->outq_credit_return = 0b00100; // port 2
+        dut->outq_credit_return = 0b00011; // ports 0,1
+        dut->downstream_credit = 0b00100; // port 2
         tick();
-        dut->downstream_credit = 0;
         dut->outq_credit_return = 0;
+        dut->downstream_credit = 0;
         tick();
         check_can_send(0, true);
         check_can_send(1, true);
@@ -188,9 +208,9 @@ public:
         // exhaust all ports then recover
         apply_reset();
         for(int i = 0; i < FIFO_DEPTH; i++){
-            dut->downstream_credit = 0x1F;
+            dut->outq_credit_return = 0x1F;
             tick();
-            dut->downstream_credit = 0;
+            dut->outq_credit_return = 0;
         }
         tick();
         check_all_can_send(0x00);
@@ -203,9 +223,9 @@ public:
         check_can_send(1, true);
         // recover all
         for(int i = 0; i < FIFO_DEPTH; i++){
-            dut->outq_credit_return = 0x1F;
+            dut->downstream_credit = 0x1F;
             tick();
-            dut->outq_credit_return = 0;
+            dut->downstream_credit = 0;
         }
         tick();
         check_all_can_send(0x1F);
@@ -224,17 +244,6 @@ public:
         check_can_send(3, true);
         check_can_send(4, true);
 
-        // upstream credit is just a passthrough of outq_credit_return
-        apply_reset();
-        dut->outq_credit_return = 0b00001; dut->eval();
-        check_upstream_credit(0b00001);
-        dut->outq_credit_return = 0b10101; dut->eval();
-        check_upstream_credit(0b10101);
-        dut->outq_credit_return = 0b11111; dut->eval();
-        check_upstream_credit(0b11111);
-        dut->outq_credit_return = 0b00000; dut->eval();
-        check_upstream_credit(0b00000);
-
         // reset in the middle of stuff
         apply_reset();
         for(int i = 0; i < 3; i++) decrement_credit(0);
@@ -247,12 +256,12 @@ public:
         // rapid toggling - dec then inc back, net zero
         apply_reset();
         for(int i = 0; i < 20; i++){
-            dut->downstream_credit = 1;
-            tick();
-            dut->downstream_credit = 0;
             dut->outq_credit_return = 1;
             tick();
             dut->outq_credit_return = 0;
+            dut->downstream_credit = 1;
+            tick();
+            dut->downstream_credit = 0;
         }
         tick();
         check_can_send(0, true);
@@ -270,24 +279,29 @@ public:
         apply_reset();
         int errors = 0;
         for(int cycle = 0; cycle < 100; cycle++){
-            uint8_t random_downstream = rand() % (1 << NUM_PORTS);
-            uint8_t random_return = rand() % (1 << NUM_PORTS);
-            // dont underflow or overflow
+            uint8_t random_sent = rand() % (1 << NUM_PORTS);
+            uint8_t random_credit = rand() % (1 << NUM_PORTS);
+            uint8_t random_take = rand() % (1 << NUM_PORTS);
+            // dont underflow or overflow; only queued packets can be sent
             for(int p = 0; p < NUM_PORTS; p++){
-                if(shadow_credit[p] == 0) random_downstream &= ~(1 << p);
-                if(shadow_credit[p] == FIFO_DEPTH) random_return &= ~(1 << p);
+                if(shadow_credit[p] == 0 || shadow_slot[p] == FIFO_DEPTH) random_sent &= ~(1 << p);
+                if(shadow_credit[p] == FIFO_DEPTH) random_credit &= ~(1 << p);
+                if(shadow_slot[p] == 0) random_take &= ~(1 << p);
             }
-            dut->downstream_credit = random_downstream;
-            dut->outq_credit_return = random_return;
+            dut->outq_credit_return = random_sent;
+            dut->downstream_credit = random_credit;
+            dut->outq_credit_take = random_take;
             tick();
-            dut->downstream_credit = 0;
             dut->outq_credit_return = 0;
+            dut->downstream_credit = 0;
+            dut->outq_credit_take = 0;
             tick();
 
             for(int p = 0; p < NUM_PORTS; p++){
                 bool expected = shadow_credit[p] != 0;
                 bool actual = (dut->can_send >> p) & 1;
                 if(actual != expected) errors++;
+                if(credit_avail(p) != (shadow_slot[p] != 0)) errors++;
             }
         }
         test_count++;
@@ -313,6 +327,29 @@ public:
         }
         check_can_send(0, true);
 
+        // output queue slots: taken at grant, returned when sent
+        apply_reset();
+        for(int i = 0; i < FIFO_DEPTH; i++) change_credit(0, 1, 0);
+        tick();
+        check_credit_avail(0, 0);
+        check_credit_avail(1, 1);
+        check_can_send(0, true); // slots dont touch downstream credits
+        change_credit(0, 0, 1);
+        tick();
+        check_credit_avail(0, 1);
+        check_can_send(0, true); // 7 downstream credits left
+
+        // sending with a full downstream buffer is blocked by can_send,
+        // not by the output queue slots
+        apply_reset();
+        for(int i = 0; i < FIFO_DEPTH; i++){
+            change_credit(0, 1, 0);
+            change_credit(0, 0, 1);
+        }
+        tick();
+        check_can_send(0, false);
+        check_credit_avail(0, 1);
+
         printf("\n%d/%d tests passed\n", passed, test_count);
         if(failed > 0) printf("%d FAILED\n", failed);
     }
@@ -1,24 +1,27 @@
 `timescale 1ns/1ps
+`include "rtl/credit_manager.v"
 
 module credit_manager_tb;
     parameter NUM_PORTS = 5;
     parameter FIFO_DEPTH = 8;
     parameter CLK_PERIOD = 10;
 
-    localparam CREDIT_W = $clog2(FIFO_DEPTH + 1);
-
     reg clk;
     reg rst;
     reg [NUM_PORTS-1:0] outq_credit_return;
+    reg [NUM_PORTS-1:0] outq_credit_take;
     reg [NUM_PORTS-1:0] downstream_credit;
     wire [NUM_PORTS-1:0] can_send;
-    wire [NUM_PORTS-1:0] upstream_credit;
+    wire [NUM_PORTS-1:0] credit_avail;
 
     integer test_count;
     integer passed;
     integer failed;
 
-    reg [CREDIT_W-1:0] shadow_credit [NUM_PORTS-1:0];
+    // shadow credits for checking: downstream credits (can_send) and
+    // free output queue slots (credit_avail)
+    integer shadow_credit [NUM_PORTS-1:0];
+    integer shadow_slot [NUM_PORTS-1:0];
     integer port_idx;
 
     //dut
@@ -29,9 +32,10 @@ module credit_manager_tb;
         .clk(clk),
         .rst(rst),
         .outq_credit_return(outq_credit_return),
+        .outq_credit_take(outq_credit_take),
         .downstream_credit(downstream_credit),
         .can_send(can_send),
-        .upstream_credit(upstream_credit)
+        .credit_avail(credit_avail)
     );
 
     initial begin
@@ -44,18 +48,22 @@ module credit_manager_tb;
         $dumpvars(0, credit_manager_tb);
     end
 
+    // a packet sent downstream spends a link credit and frees its output
+    // queue slot; a downstream credit gives the link credit back
     always @(posedge clk) begin
         if (rst) begin
             for (port_idx = 0; port_idx < NUM_PORTS; port_idx = port_idx + 1) begin
                 shadow_credit[port_idx] <= FIFO_DEPTH;
+                shadow_slot[port_idx] <= FIFO_DEPTH;
             end
         end else begin
             for (port_idx = 0; port_idx < NUM_PORTS; port_idx = port_idx + 1) begin
-                case ({downstream_credit[port_idx], outq_credit_return[port_idx]})
-                    2'b10: shadow_credit[port_idx] <= shadow_credit[port_idx] - 1;
-                    2'b01: shadow_credit[port_idx] <= shadow_credit[port_idx] + 1;
-                    default: ;
-                endcase
+                shadow_credit[port_idx] <= shadow_credit[port_idx]
+                                         + downstream_credit[port_idx]
+                                         - outq_credit_return[port_idx];
+                shadow_slot[port_idx] <= shadow_slot[port_idx]
+                                       + outq_credit_return[port_idx]
+                                       - outq_credit_take[port_idx];
             end
         end
     end
@@ -64,6 +72,7 @@ module credit_manager_tb;
         begin
             rst = 1;
             outq_credit_return = 0;
+            outq_credit_take = 0;
             downstream_credit = 0;
         end
     endtask
@@ -117,35 +126,41 @@ module credit_manager_tb;
         end
     endtask
 
-    task check_upstream_credit;
-        input [NUM_PORTS-1:0] expected;
+    task check_credit_avail;
+        input integer port;
+        input expected;
         begin
             test_count = test_count + 1;
-            if (upstream_credit === expected) begin
+            if (credit_avail[port] === expected) begin
                 passed = passed + 1;
-                $display("PASSED, Test: %0d, upstream_credit=%b, expected=%b", test_count, upstream_credit, expected);
+                $display("PASSED, Test: %0d, credit_avail[%0d]=%b, expected=%b", test_count, port, credit_avail[port], expected);
             end else begin
                 failed = failed + 1;
-                $display("FAILED, Test: %0d, upstream_credit=%b, expected=%b", test_count, upstream_credit, expected);
+                $display("FAILED, Test: %0d, credit_avail[%0d]=%b, expected=%b", test_count, port, credit_avail[port], expected);
             end
         end
     endtask
 
+    // packet granted into the output queue and sent downstream in the
+    // same cycle: spends a link credit, queue slots unchanged
     task decrement_credit;
         input integer port;
         begin
-            downstream_credit[port] = 1;
+            outq_credit_take[port] = 1;
+            outq_credit_return[port] = 1;
             @(posedge clk);
-            downstream_credit[port] = 0;
+            outq_credit_take[port] = 0;
+            outq_credit_return[port] = 0;
         end
     endtask
 
+    // credit returned by the downstream router
     task increment_credit;
         input integer port;
         begin
-            outq_credit_return[port] = 1;
+            downstream_credit[port] = 1;
             @(posedge clk);
-            outq_credit_return[port] = 0;
+            downstream_credit[port] = 0;
         end
     endtask
 
@@ -201,21 +216,27 @@ module credit_manager_tb;
         @(posedge clk);
 
         downstream_credit[0] = 1;
+        outq_credit_take[0] = 1;
         outq_credit_return[0] = 1;
         @(posedge clk);
         downstream_credit[0] = 0;
+        outq_credit_take[0] = 0;
         outq_credit_return[0] = 0;
         @(posedge clk);
         check_can_send(0, 1);
 
         //multi-port operations
         apply_reset();
-        downstream_credit[0] = 1;
-        downstream_credit[1] = 1;
-        outq_credit_return[2] = 1;
+        decrement_credit(2);
+        outq_credit_take[0] = 1;
+        outq_credit_take[1] = 1;
+        outq_credit_return[0] = 1;
+        outq_credit_return[1] = 1;
+        downstream_credit[2] = 1;
         @(posedge clk);
-        downstream_credit = 0;
+        outq_credit_take = 0;
         outq_credit_return = 0;
+        downstream_credit = 0;
         @(posedge clk);
         check_can_send(0, 1);
         check_can_send(1, 1);
@@ -224,9 +245,11 @@ module credit_manager_tb;
         //exhaustion and recovery
         apply_reset();
         repeat (FIFO_DEPTH) begin
-            downstream_credit = {NUM_PORTS{1'b1}};
+            outq_credit_take = {NUM_PORTS{1'b1}};
+            outq_credit_return = {NUM_PORTS{1'b1}};
             @(posedge clk);
-            downstream_credit = 0;
+            outq_credit_take = 0;
+            outq_credit_return = 0;
         end
         @(posedge clk);
         check_all_can_send({NUM_PORTS{1'b0}});
@@ -241,9 +264,9 @@ module credit_manager_tb;
         check_can_send(1, 1);
 
         repeat (FIFO_DEPTH) begin
-            outq_credit_return = {NUM_PORTS{1'b1}};
+            downstream_credit = {NUM_PORTS{1'b1}};
             @(posedge clk);
-            outq_credit_return = 0;
+            downstream_credit = 0;
         end
         @(posedge clk);
         check_all_can_send({NUM_PORTS{1'b1}});
@@ -263,24 +286,6 @@ module credit_manager_tb;
         check_can_send(3, 1);
         check_can_send(4, 1);
 
-        //upstream credit passthrough
-        apply_reset();
-        outq_credit_return = 5'b00001;
-        #1;
-        check_upstream_credit(5'b00001);
-
-        outq_credit_return = 5'b10101;
-        #1;
-        check_upstream_credit(5'b10101);
-
-        outq_credit_return = 5'b11111;
-        #1;
-        check_upstream_credit(5'b11111);
-
-        outq_credit_return = 5'b00000;
-        #1;
-        check_upstream_credit(5'b00000);
-
         //reset during operation
         apply_reset();
         repeat (3) decrement_credit(0);
@@ -294,12 +299,8 @@ module credit_manager_tb;
         //rapid toggling
         apply_reset();
         repeat (20) begin
-            downstream_credit[0] = 1;
-            @(posedge clk);
-            downstream_credit[0] = 0;
-            outq_credit_return[0] = 1;
-            @(posedge clk);
-            outq_credit_return[0] = 0;
+            decrement_credit(0);
+            increment_credit(0);
         end
         @(posedge clk);
         check_can_send(0, 1);
@@ -313,40 +314,70 @@ module credit_manager_tb;
         @(posedge clk);
         check_can_send(0, 0);
 
+        //output queue slots: taken at grant, returned when sent
+        apply_reset();
+        repeat (FIFO_DEPTH) begin
+            outq_credit_take[0] = 1;
+            @(posedge clk);
+            outq_credit_take[0] = 0;
+        end
+        @(posedge clk);
+        check_credit_avail(0, 0);
+        check_credit_avail(1, 1);
+        check_can_send(0, 1);
+
+        outq_credit_return[0] = 1;
+        @(posedge clk);
+        outq_credit_return[0] = 0;
+        @(posedge clk);
+        check_credit_avail(0, 1);
+        check_can_send(0, 1);
+
         //stress test
         apply_reset();
         begin: stress_test
             integer cycle;
             integer p;
             integer errors;
-            reg [NUM_PORTS-1:0] random_downstream;
-            reg [NUM_PORTS-1:0] random_return;
+            reg [NUM_PORTS-1:0] random_sent;
+            reg [NUM_PORTS-1:0] random_take;
+            reg [NUM_PORTS-1:0] random_credit;
 
             errors = 0;
             for (cycle = 0; cycle < 100; cycle = cycle + 1) begin
-                random_downstream = $random;
-                random_return = $random;
+                random_sent = $random;
+                random_take = $random;
+                random_credit = $random;
 
+                // dont underflow or overflow; only queued packets can be sent
                 for (p = 0; p < NUM_PORTS; p = p + 1) begin
-                    if (shadow_credit[p] == 0) begin
-                        random_downstream[p] = 0;
+                    if (shadow_credit[p] == 0 || shadow_slot[p] == FIFO_DEPTH) begin
+                        random_sent[p] = 0;
                     end
                     if (shadow_credit[p] == FIFO_DEPTH) begin
-                        random_return[p] = 0;
+                        random_credit[p] = 0;
+                    end
+                    if (shadow_slot[p] == 0) begin
+                        random_take[p] = 0;
                     end
                 end
 
-                downstream_credit = random_downstream;
-                outq_credit_return = random_return;
+                outq_credit_return = random_sent;
+                outq_credit_take = random_take;
+                downstream_credit = random_credit;
                 @(posedge clk);
-                downstream_credit = 0;
                 outq_credit_return = 0;
+                outq_credit_take = 0;
+                downstream_credit = 0;
                 @(posedge clk);
 
                 for (p = 0; p < NUM_PORTS; p = p + 1) begin
                     if (can_send[p] !== (shadow_credit[p] != 0)) begin
                         errors = errors + 1;
                     end
+                    if (credit_avail[p] !== (shadow_slot[p] != 0)) begin
+                        errors = errors + 1;
+                    end
                 end
             end
 
@@ -355,6 +386,7 @@ module credit_manager_tb;
                 passed = passed + 1;
             end else begin
                 failed = failed + 1;
+                $display("FAILED, Test: %0d, stress errors=%0d", test_count, errors);
             end
         end
 
@@ -0,0 +1,343 @@
+// Design-space exploration driver for noc_router.
+//
+// Builds one Verilated variant per (NUM_PORTS, FIFO_DEPTH, PACKET_WIDTH)
+// grid point with -G overrides, runs noc_router_bench_tb on each, and
+// prints a Pareto table over
+//   * bandwidth     saturation throughput x NUM_PORTS x PACKET_WIDTH (bits/cycle)
+//   * latency       average latency at the benchmark load (cycles)
+//   * buffer bits   area proxy: NUM_PORTS^2 VOQs + NUM_PORTS output queues,
+//                   each FIFO_DEPTH x PACKET_WIDTH
+//
+// Points build in parallel into <cache>/np<P>_fd<D>_pw<W>. A stamp file holds
+// a hash of the RTL, the benchmark sources, the build command and the
+// Verilator version; a repeated sweep only rebuilds points whose stamp no
+// longer matches.
+//
+// Usage:
+//   noc_router_dse --rtl=DIR --tb=DIR [--cache=DIR] [--jobs=N]
+//                  [--ports=4,5,8] [--fifo-depth=4,8,16]
+//                  [--packet-width=64,128,256]
+//                  [--cycles=N] [--warmup=N] [--rate=R] [--csv=FILE]
+//
+// Build: g++ -O2 -std=c++17 -pthread -o noc_router_dse noc_router_dse.cpp
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Sources and lint waivers shared with the run_*.sh scripts
+static const char* FILE_LIST = "noc_router.f";
+
+struct DsePoint {
+    int ports;
+    int fifo_depth;
+    int packet_width;
+    std::string dir;
+
+    bool cached = false;
+    bool ok = false;
+    std::string error;
+
+    double throughput = 0.0;   // pkt/port/cycle at saturation
+    double latency = 0.0;      // cycles at the benchmark load
+    double bandwidth = 0.0;    // bits/cycle
+    long long buffer_bits = 0;
+    bool pareto = false;
+};
+
+// -----------------------------
+// Helpers
+// -----------------------------
+static const char* arg(int argc, char** argv, const char* key) {
+    size_t n = strlen(key);
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strncmp(a, "--", 2) == 0 && strncmp(a + 2, key, n) == 0 && a[2 + n] == '=')
+            return a + 3 + n;
+    }
+    return nullptr;
+}
+
+static std::vector<int> int_list(const char* s, std::vector<int> def) {
+    if (!s) return def;
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty()) out.push_back(atoi(item.c_str()));
+    return out;
+}
+
+static std::string read_file(const fs::path& p) {
+    std::ifstream in(p, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// Source files named in a Verilator -F list (options and comments skipped)
+static std::vector<std::string> list_sources(const fs::path& p) {
+    std::vector<std::string> files;
+    std::istringstream in(read_file(p));
+    std::string tok;
+    while (in >> tok) {
+        if (tok.rfind("//", 0) == 0 || tok[0] == '#') {
+            std::string rest;
+            std::getline(in, rest);
+        } else if (tok[0] != '-') {
+            files.push_back(tok);
+        }
+    }
+    return files;
+}
+
+static std::string run_capture(const std::string& cmd) {
+    std::string out;
+    FILE* f = popen(cmd.c_str(), "r");
+    if (!f) return out;
+    char buf[256];
+    while (fgets(buf, sizeof(buf), f)) out += buf;
+    pclose(f);
+    return out;
+}
+
+// FNV-1a, 64 bit
+static uint64_t fnv1a(const std::string& s, uint64_t h = 0xcbf29ce484222325ull) {
+    for (unsigned char c : s) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+static std::string hex64(uint64_t v) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)v);
+    return buf;
+}
+
+// -----------------------------
+// Build / run one point
+// -----------------------------
+struct DseConfig {
+    fs::path rtl_dir;
+    fs::path tb_dir;
+    fs::path cache_dir;
+    std::string bench_args;
+    uint64_t source_hash;   // RTL + benchmark sources + Verilator version
+};
+
+static std::string build_command(const DseConfig& cfg, const DsePoint& p) {
+    fs::path obj = fs::path(p.dir) / "obj_dir";
+    std::ostringstream cmd;
+    cmd << "verilator -F '" << (cfg.rtl_dir / FILE_LIST).string() << "' -cc"
+        << " --top-module noc_router"
+        << " -GNUM_PORTS=" << p.ports
+        << " -GFIFO_DEPTH=" << p.fifo_depth
+        << " -GPACKET_WIDTH=" << p.packet_width
+        << " -CFLAGS '-O2 -I" << (cfg.tb_dir / ".." / "common").string()
+        << " -DNUM_PORTS=" << p.ports
+        << " -DFIFO_DEPTH=" << p.fifo_depth
+        << " -DPACKET_WIDTH=" << p.packet_width << "'"
+        << " --exe '" << (cfg.tb_dir / "noc_router_bench_tb.cpp").string() << "'"
+        << " -Mdir '" << obj.string() << "'";
+    return cmd.str();
+}
+
+static void build_point(const DseConfig& cfg, DsePoint& p) {
+    fs::create_directories(p.dir);
+    fs::path obj = fs::path(p.dir) / "obj_dir";
+    fs::path stamp = fs::path(p.dir) / "build.stamp";
+    fs::path log = fs::path(p.dir) / "build.log";
+
+    std::string cmd = build_command(cfg, p);
+    std::string key = hex64(fnv1a(cmd, cfg.source_hash));
+
+    if (fs::exists(obj / "Vnoc_router") && fs::exists(stamp) && read_file(stamp) == key) {
+        p.cached = true;
+        return;
+    }
+
+    fs::remove(stamp);
+    std::string full = cmd + " > '" + log.string() + "' 2>&1"
+                     + " && make -C '" + obj.string() + "' -f Vnoc_router.mk Vnoc_router"
+                     + " >> '" + log.string() + "' 2>&1";
+    if (std::system(full.c_str()) != 0) {
+        p.error = "build failed, see " + log.string();
+        return;
+    }
+    std::ofstream(stamp) << key;
+}
+
+static void run_point(const DseConfig& cfg, DsePoint& p) {
+    fs::path bin = fs::path(p.dir) / "obj_dir" / "Vnoc_router";
+    fs::path log = fs::path(p.dir) / "bench.log";
+    std::string cmd = "'" + bin.string() + "' " + cfg.bench_args + " > '" + log.string() + "' 2>&1";
+    int rc = std::system(cmd.c_str());
+
+    std::string out = read_file(log);
+    size_t pos = out.rfind("RESULT ");
+    int errors = 0;
+    if (pos == std::string::npos ||
+        sscanf(out.c_str() + pos, "RESULT throughput=%lf latency=%lf errors=%d",
+               &p.throughput, &p.latency, &errors) != 3) {
+        p.error = "no RESULT line, see " + log.string();
+        return;
+    }
+    if (rc != 0 || errors != 0) {
+        p.error = "benchmark reported errors, see " + log.string();
+        return;
+    }
+
+    p.bandwidth = p.throughput * p.ports * p.packet_width;
+    // per input: one VOQ per output plus the one-packet multicast slot;
+    // per output: the output queue
+    p.buffer_bits = (long long)p.ports * ((p.ports + 1) * p.fifo_depth + 1) * p.packet_width;
+    p.ok = true;
+}
+
+// p dominates q: no worse on every axis, better on at least one
+static bool dominates(const DsePoint& p, const DsePoint& q) {
+    bool no_worse = p.bandwidth >= q.bandwidth && p.latency <= q.latency &&
+                    p.buffer_bits <= q.buffer_bits;
+    bool better = p.bandwidth > q.bandwidth || p.latency < q.latency ||
+                  p.buffer_bits < q.buffer_bits;
+    return no_worse && better;
+}
+
+int main(int argc, char** argv) {
+    const char* rtl = arg(argc, argv, "rtl");
+    const char* tb = arg(argc, argv, "tb");
+    if (!rtl || !tb) {
+        fprintf(stderr, "usage: %s --rtl=DIR --tb=DIR [--cache=DIR] [--jobs=N] [--ports=..] "
+                        "[--fifo-depth=..] [--packet-width=..] [--cycles=N] [--warmup=N] "
+                        "[--rate=R] [--csv=FILE]\n", argv[0]);
+        return 1;
+    }
+
+    DseConfig cfg;
+    cfg.rtl_dir = fs::absolute(rtl);
+    cfg.tb_dir = fs::absolute(tb);
+    cfg.cache_dir = fs::absolute(arg(argc, argv, "cache") ? arg(argc, argv, "cache")
+                                                          : (cfg.tb_dir / "dse_cache").string());
+
+    std::vector<int> ports = int_list(arg(argc, argv, "ports"), {4, 5, 8});
+    std::vector<int> depths = int_list(arg(argc, argv, "fifo-depth"), {4, 8, 16});
+    std::vector<int> widths = int_list(arg(argc, argv, "packet-width"), {64, 128, 256});
+
+    const char* jobs_s = arg(argc, argv, "jobs");
+    int jobs = jobs_s ? atoi(jobs_s) : (int)std::thread::hardware_concurrency();
+    if (jobs < 1) jobs = 1;
+
+    std::ostringstream bench;
+    bench << "--cycles=" << (arg(argc, argv, "cycles") ? arg(argc, argv, "cycles") : "10000")
+          << " --warmup=" << (arg(argc, argv, "warmup") ? arg(argc, argv, "warmup") : "1000")
+          << " --rate=" << (arg(argc, argv, "rate") ? arg(argc, argv, "rate") : "0.3");
+    cfg.bench_args = bench.str();
+
+    // Everything a variant depends on besides its own parameters
+    uint64_t h = fnv1a(run_capture("verilator --version"));
+    h = fnv1a(read_file(cfg.rtl_dir / FILE_LIST), h);
+    for (const std::string& f : list_sources(cfg.rtl_dir / FILE_LIST))
+        h = fnv1a(read_file(cfg.rtl_dir / f), h);
+    h = fnv1a(read_file(cfg.tb_dir / "noc_router_bench_tb.cpp"), h);
+    h = fnv1a(read_file(cfg.tb_dir / ".." / "common" / "noc_router_harness.h"), h);
+    cfg.source_hash = h;
+
+    std::vector<DsePoint> points;
+    for (int np : ports) {
+        for (int fd : depths) {
+            for (int pw : widths) {
+                // route_compute resolves 12 ports, packet_fifo pointers wrap
+                // at a power of two, the harness header + payload needs
+                // 55 bits plus the multicast destination set
+                if (np < 2 || np > 12 || fd < 2 || (fd & (fd - 1)) != 0 || pw < 55 + np) {
+                    fprintf(stderr, "skipping NUM_PORTS=%d FIFO_DEPTH=%d PACKET_WIDTH=%d "
+                                    "(need 2..12 ports, power-of-two depth, width >= %d)\n",
+                            np, fd, pw, 55 + np);
+                    continue;
+                }
+                DsePoint p;
+                p.ports = np;
+                p.fifo_depth = fd;
+                p.packet_width = pw;
+                p.dir = (cfg.cache_dir / ("np" + std::to_string(np) + "_fd" + std::to_string(fd) +
+                                          "_pw" + std::to_string(pw))).string();
+                points.push_back(p);
+            }
+        }
+    }
+
+    printf("noc_router DSE: %zu points, %d jobs, cache %s\n",
+           points.size(), jobs, cfg.cache_dir.string().c_str());
+
+    // Worker pool: each worker builds (or reuses) and benchmarks one point
+    std::atomic<size_t> next{0};
+    std::mutex print_mtx;
+    std::vector<std::thread> workers;
+    for (int j = 0; j < jobs; j++) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < points.size(); i = next++) {
+                DsePoint& p = points[i];
+                build_point(cfg, p);
+                if (p.error.empty()) run_point(cfg, p);
+                std::lock_guard<std::mutex> lock(print_mtx);
+                printf("  [%s] np=%d fd=%d pw=%d %s\n", p.ok ? "done" : "FAIL",
+                       p.ports, p.fifo_depth, p.packet_width,
+                       p.ok ? (p.cached ? "(cached build)" : "(built)") : p.error.c_str());
+                fflush(stdout);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    for (auto& p : points) {
+        if (!p.ok) continue;
+        p.pareto = true;
+        for (const auto& q : points)
+            if (q.ok && dominates(q, p)) { p.pareto = false; break; }
+    }
+
+    std::vector<DsePoint*> order;
+    for (auto& p : points) if (p.ok) order.push_back(&p);
+    std::sort(order.begin(), order.end(), [](const DsePoint* a, const DsePoint* b) {
+        if (a->buffer_bits != b->buffer_bits) return a->buffer_bits < b->buffer_bits;
+        return a->bandwidth > b->bandwidth;
+    });
+
+    printf("\n%-6s %5s %5s %5s %12s %10s %12s %10s\n",
+           "pareto", "ports", "depth", "width", "buffer_bits", "thr/port", "bw(b/cyc)", "latency");
+    for (const DsePoint* p : order) {
+        printf("%-6s %5d %5d %5d %12lld %10.4f %12.1f %10.2f\n",
+               p->pareto ? "*" : "", p->ports, p->fifo_depth, p->packet_width,
+               p->buffer_bits, p->throughput, p->bandwidth, p->latency);
+    }
+
+    const char* csv = arg(argc, argv, "csv");
+    if (csv) {
+        std::ofstream out(csv);
+        out << "ports,fifo_depth,packet_width,buffer_bits,throughput,bandwidth,latency,pareto\n";
+        for (const DsePoint* p : order) {
+            out << p->ports << "," << p->fifo_depth << "," << p->packet_width << ","
+                << p->buffer_bits << "," << p->throughput << "," << p->bandwidth << ","
+                << p->latency << "," << (p->pareto ? 1 : 0) << "\n";
+        }
+        printf("\nResults written to %s\n", csv);
+    }
+
+    bool all_ok = std::all_of(points.begin(), points.end(), [](const DsePoint& p) { return p.ok; });
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,472 @@
+#include <iostream>
+#include <cstdlib>
+#include "noc_router_harness.h"
+
+// Multicast / broadcast test and bandwidth comparison.
+//
+// Directed tests on one router check that a multicast packet crosses the
+// input link once and reaches every output in its destination set (and
+// only those), that broadcast and link-down targets behave, that multicast
+// heads contending for the same outputs are all delivered, and that
+// multicast copies stay in order with the unicasts from the same source,
+// without the input waiting for the target VOQs to drain.
+//
+// The comparison uses two routers in a row, A -> B. Sources on A send to
+// endpoints behind B; a multicast is addressed to B, so A forwards it as a
+// single packet and B forks it. The same message stream is run twice: once
+// with router multicast, once with every multicast sent by the source as
+// one unicast per target (software emulation). Flits on the A -> B link
+// are counted from the RTL handshake. The table reports link flits, link
+// occupancy, cycles to deliver everything and latency.
+//
+// Options: --cycles=N --mc-frac=F --seed=S
+
+static_assert(NUM_PORTS >= 5, "the A -> B chain uses B's N, S, E and NE outputs");
+
+static const double RATES[] = {0.05, 0.1, 0.2};
+
+static int test_count = 0;
+static int passed = 0;
+
+static void check(bool ok, const char* what) {
+    test_count++;
+    if (ok) passed++;
+    else printf("FAIL test %d: %s\n", test_count, what);
+}
+
+// Send one multicast from src and let it drain
+static void send_one(NocRouterHarness* tb, int src, uint32_t set) {
+    tb->clear_stats();
+    tb->push_flit(src, __builtin_ctz(set), set);
+    tb->drain(1000);
+}
+
+static void directed_tests() {
+    const uint32_t all = (1u << NUM_PORTS) - 1;
+    NocRouterHarness* tb = new NocRouterHarness(1);
+    tb->apply_reset();
+    tb->traffic.rate = 0.0;
+
+    // Multicast to three outputs: one link flit, three copies
+    send_one(tb, 0, 0b10110);
+    check(tb->errors == 0 && tb->link_flits == 1 && tb->delivered == 3, "multicast to {1,2,4}");
+
+    // Broadcast, including back out of the source port
+    send_one(tb, 3, all);
+    check(tb->errors == 0 && tb->link_flits == 1 && tb->delivered == NUM_PORTS, "broadcast");
+
+    // Targets on a link that is down are dropped from the set
+    tb->dut->link_up = all & ~(1u << 2);
+    send_one(tb, 1, 0b00101);
+    check(tb->errors == 0 && tb->link_flits == 1 && tb->delivered == 1, "multicast with link down");
+    tb->dut->link_up = all;
+
+    // Unicasts before and after a multicast from the same source leave
+    // each output in order (the scoreboard checks the sequence numbers)
+    tb->clear_stats();
+    tb->push_flit(0, 1, 0);
+    tb->push_flit(0, 2, 0);
+    tb->push_flit(0, 1, 0b00110);
+    tb->push_flit(0, 1, 0);
+    tb->push_flit(0, 2, 0);
+    bool drained = tb->drain(1000);
+    check(drained && tb->errors == 0 && tb->delivered == 6, "unicast / multicast order");
+
+    // Every input multicasts to all other outputs at once: each head is
+    // held until all of its outputs have granted it
+    tb->clear_stats();
+    for (int n = 0; n < 4; n++)
+        for (int i = 0; i < NUM_PORTS; i++) tb->push_flit(i, (i + 1) % NUM_PORTS, all & ~(1u << i));
+    drained = tb->drain(5000);
+    check(drained && tb->errors == 0 && tb->delivered == 4ull * NUM_PORTS * (NUM_PORTS - 1),
+          "contending multicasts");
+
+    // Unicast and multicast mixed
+    TrafficConfig cfg;
+    cfg.rate = 0.5;
+    cfg.mc_frac = 0.3;
+    cfg.mc_fanout = 3;
+    tb->run_window(cfg, 0, 5000, 50000);
+    check(tb->idle() && tb->errors == 0, "mixed unicast / multicast traffic");
+
+    delete tb;
+}
+
+// -----------------------------
+// Two-router chain
+// -----------------------------
+// A sits at local (1,1), B at local (2,1); A's east output drives B's west
+// input. Only A's east link is up, so route_compute sends everything A
+// receives onto that link (diagonal and south-east destinations are
+// rerouted east). Sources are A's other inputs; targets are endpoints
+// behind B's N, S, E and NE outputs.
+static const int CHAIN_SRC[] = {0, 1, 3, 4};
+static const int CHAIN_DST[] = {0, 1, 2, 4};
+#define CHAIN_N 4
+
+static const int A_POS[4] = {CUR_TILE, CUR_TILE, 1, 1};
+static const int B_POS[4] = {CUR_TILE, CUR_TILE, 2, 1};
+
+// Endpoint that B routes out of output p
+static const int B_DST[NUM_PORTS][4] = {
+    {CUR_TILE, CUR_TILE, 2, 2}, // N
+    {CUR_TILE, CUR_TILE, 2, 0}, // S
+    {CUR_TILE, CUR_TILE, 3, 1}, // E
+    {CUR_TILE, CUR_TILE, 1, 1}, // W (back to A, never a target)
+    {CUR_TILE, CUR_TILE, 3, 2}, // NE
+};
+
+#define LINK_OUT 2 // A's east output
+#define LINK_IN  3 // B's west input
+
+struct NocChain {
+    Vnoc_router* a;
+    Vnoc_router* b;
+    XorShift64 rng;
+    TrafficConfig traffic;
+    uint64_t cycle;
+
+    std::deque<Flit> src_q[NUM_PORTS];
+    std::deque<Flit> expect[NUM_PORTS][NUM_PORTS];
+    uint32_t next_seq[NUM_PORTS];
+
+    // B's credits, returned the cycle after its sinks take a packet. A's
+    // link credit comes from B's upstream_credit on the link input.
+    uint32_t b_credit;
+    uint32_t b_stall;      // B outputs whose sinks are not ready
+
+    uint64_t messages;
+    uint64_t link_flits;   // packets sent on the A -> B link
+    uint64_t delivered;
+    uint64_t latency_sum;
+    int errors;
+
+    explicit NocChain(uint64_t seed) : rng(seed) {
+        a = new Vnoc_router;
+        b = new Vnoc_router;
+        cycle = 0;
+        for (int i = 0; i < NUM_PORTS; i++) next_seq[i] = 0;
+        b_credit = 0;
+        b_stall = 0;
+        messages = 0;
+        link_flits = 0;
+        delivered = 0;
+        latency_sum = 0;
+        errors = 0;
+    }
+
+    ~NocChain() {
+        a->final();
+        b->final();
+        delete a;
+        delete b;
+    }
+
+    static void place(Vnoc_router* r, const int pos[4], uint32_t link_up) {
+        r->clk = 0;
+        r->rst = 1;
+        r->cur_x = pos[0];
+        r->cur_y = pos[1];
+        r->cur_lx = pos[2];
+        r->cur_ly = pos[3];
+        r->link_up = link_up;
+        r->in_valid = 0;
+        r->out_ready = 0;
+        r->downstream_credit = 0;
+        r->eval();
+    }
+
+    void apply_reset() {
+        place(a, A_POS, 1u << LINK_OUT);
+        place(b, B_POS, (1u << NUM_PORTS) - 1);
+        for (int i = 0; i < 3; i++) {
+            for (int clk = 0; clk < 2; clk++) {
+                a->clk = clk;
+                b->clk = clk;
+                a->eval();
+                b->eval();
+            }
+        }
+        a->rst = 0;
+        b->rst = 0;
+        a->eval();
+        b->eval();
+    }
+
+    void push_flit(int src, int dst, uint32_t mc_set) {
+        Flit f;
+        f.src = src;
+        f.dst = dst;
+        f.seq = next_seq[src]++;
+        f.inject_cycle = cycle;
+        f.mc_set = mc_set;
+        src_q[src].push_back(f);
+    }
+
+    uint32_t pick_mc_set() {
+        int k = traffic.mc_fanout < CHAIN_N ? traffic.mc_fanout : CHAIN_N;
+        uint32_t set = 0;
+        for (int n = 0; n < k;) {
+            int o = CHAIN_DST[rng.below(CHAIN_N)];
+            if (!((set >> o) & 1)) {
+                set |= 1u << o;
+                n++;
+            }
+        }
+        return set;
+    }
+
+    void generate() {
+        for (int src : CHAIN_SRC) {
+            if (rng.uniform() < traffic.rate) {
+                messages++;
+                if (traffic.mc_frac > 0 && rng.uniform() < traffic.mc_frac) {
+                    uint32_t set = pick_mc_set();
+                    if (!traffic.mc_emulate) {
+                        push_flit(src, __builtin_ctz(set), set);
+                    } else {
+                        for (int o = 0; o < NUM_PORTS; o++)
+                            if ((set >> o) & 1) push_flit(src, o, 0);
+                    }
+                } else {
+                    push_flit(src, CHAIN_DST[rng.below(CHAIN_N)], 0);
+                }
+            }
+        }
+    }
+
+    void tick() {
+        generate();
+
+        uint32_t valid = 0;
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (!src_q[i].empty()) {
+                const Flit& f = src_q[i].front();
+                Packet p = f.mc_set ? make_packet_at(B_POS, f.src, f.seq, 0, f.mc_set)
+                                    : make_packet_at(B_DST[f.dst], f.src, f.seq);
+                to_model(a->in_packet[i], p);
+                valid |= 1u << i;
+            }
+        }
+        a->in_valid = valid;
+        a->downstream_credit = ((b->upstream_credit >> LINK_IN) & 1u) << LINK_OUT;
+        b->out_ready = ((1u << NUM_PORTS) - 1) & ~b_stall;
+        b->downstream_credit = b_credit;
+
+        // Falling edge, then settle the link: A's out_valid only depends
+        // on registered state, B's in_ready on the packet A offers
+        a->clk = 0;
+        b->clk = 0;
+        a->out_ready = (1u << NUM_PORTS) - 1;
+        a->eval();
+        b->in_valid = ((a->out_valid >> LINK_OUT) & 1u) << LINK_IN;
+        b->in_packet[LINK_IN] = a->out_packet[LINK_OUT];
+        b->eval();
+        a->out_ready = ((1u << NUM_PORTS) - 1) & ~(1u << LINK_OUT);
+        a->out_ready |= ((b->in_ready >> LINK_IN) & 1u) << LINK_OUT;
+        a->eval();
+
+        uint32_t accepted = a->in_valid & a->in_ready;
+        bool link = (a->out_valid & a->out_ready) >> LINK_OUT & 1u;
+        uint32_t fired = b->out_valid & b->out_ready;
+        for (int o = 0; o < NUM_PORTS; o++) {
+            if ((fired >> o) & 1) {
+                Packet p;
+                from_model(p, b->out_packet[o]);
+                score(o, p);
+            }
+        }
+        if (a->out_valid & ~(1u << LINK_OUT)) {
+            errors++;
+            printf("FAIL cycle %llu: A sent on a link that is down\n", (unsigned long long)cycle);
+        }
+
+        a->clk = 1;
+        b->clk = 1;
+        a->eval();
+        b->eval();
+
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if ((accepted >> i) & 1) {
+                const Flit& f = src_q[i].front();
+                if (f.mc_set) {
+                    for (int o = 0; o < NUM_PORTS; o++)
+                        if ((f.mc_set >> o) & 1) expect[i][o].push_back(f);
+                } else {
+                    expect[i][f.dst].push_back(f);
+                }
+                src_q[i].pop_front();
+            }
+        }
+        link_flits += link;
+        b_credit = fired;
+        cycle++;
+    }
+
+    void score(int out, const Packet& p) {
+        int src = pkt_get(p, PKT_SRC_LSB, PKT_SRC_W);
+        uint32_t seq = pkt_get(p, PKT_SEQ_LSB, PKT_SEQ_W);
+        if (src >= NUM_PORTS || expect[src][out].empty()) {
+            errors++;
+            printf("FAIL cycle %llu: unexpected packet on B output %d (src=%d seq=%u)\n",
+                   (unsigned long long)cycle, out, src, seq);
+            return;
+        }
+        std::deque<Flit>& q = expect[src][out];
+        if (q.front().seq != seq) {
+            errors++;
+            printf("FAIL cycle %llu: B output %d src %d got seq %u expected %u\n",
+                   (unsigned long long)cycle, out, src, seq, q.front().seq);
+        }
+        delivered++;
+        latency_sum += cycle - q.front().inject_cycle;
+        q.pop_front();
+    }
+
+    bool idle() {
+        for (int i = 0; i < NUM_PORTS; i++) {
+            if (!src_q[i].empty()) return false;
+            for (int o = 0; o < NUM_PORTS; o++)
+                if (!expect[i][o].empty()) return false;
+        }
+        return true;
+    }
+
+    bool drain(uint64_t max_cycles) {
+        traffic.rate = 0.0;
+        uint64_t c = 0;
+        while (!idle() && c++ < max_cycles) tick();
+        if (!idle()) {
+            errors++;
+            printf("FAIL: chain did not drain within %llu cycles\n", (unsigned long long)max_cycles);
+            return false;
+        }
+        return true;
+    }
+};
+
+static void chain_tests() {
+    NocChain* ch = new NocChain(1);
+    ch->apply_reset();
+    ch->traffic.rate = 0.0;
+
+    // A broadcast to B's endpoints crosses the link once and B forks it
+    uint32_t set = (1u << 0) | (1u << 1) | (1u << 2) | (1u << 4);
+    ch->push_flit(0, 0, set);
+    bool drained = ch->drain(1000);
+    check(drained && ch->errors == 0 && ch->link_flits == 1 && ch->delivered == 4,
+          "multicast forked at the second router");
+
+    // Unicasts to each of B's endpoints cross the link once each
+    for (int o : CHAIN_DST) ch->push_flit(1, o, 0);
+    drained = ch->drain(1000);
+    check(drained && ch->errors == 0 && ch->link_flits == 5 && ch->delivered == 8,
+          "unicasts through the chain");
+
+    // With B's sink stalled, B's input VOQ and output queue fill up. A
+    // then runs out of link credits and stops offering, rather than
+    // offering into a B that is not ready.
+    ch->b_stall = 1u << 0;
+    for (int n = 0; n < 3 * FIFO_DEPTH; n++) ch->push_flit(1, 0, 0);
+    for (int c = 0; c < 200; c++) ch->tick();
+    check(ch->link_flits == 5 + 2 * FIFO_DEPTH && !((ch->a->out_valid >> LINK_OUT) & 1u),
+          "link credits come back from B's input buffer");
+    ch->b_stall = 0;
+    drained = ch->drain(1000);
+    check(drained && ch->errors == 0 && ch->delivered == 8 + 3 * FIFO_DEPTH,
+          "stalled link drains in order");
+
+    // A multicast behind unicasts still queued for one of its targets is
+    // accepted at once: its other target, and a unicast that follows it,
+    // are delivered while B's output 0 is stalled
+    uint64_t before = ch->delivered;
+    ch->b_stall = 1u << 0;
+    for (int n = 0; n < FIFO_DEPTH + FIFO_DEPTH / 2; n++) ch->push_flit(1, 0, 0);
+    ch->push_flit(1, 0, (1u << 0) | (1u << 1));
+    ch->push_flit(1, 1, 0);
+    for (int c = 0; c < 200; c++) ch->tick();
+    check(ch->errors == 0 && ch->delivered == before + 2,
+          "multicast does not wait for its target VOQs to drain");
+    ch->b_stall = 0;
+    drained = ch->drain(1000);
+    check(drained && ch->errors == 0 && ch->delivered == before + FIFO_DEPTH + FIFO_DEPTH / 2 + 3,
+          "multicast behind queued unicasts keeps order");
+
+    delete ch;
+}
+
+struct McResult {
+    uint64_t messages;
+    uint64_t link_flits;
+    uint64_t delivered;
+    uint64_t cycles;
+    double latency;
+    int errors;
+};
+
+static McResult run_chain(bool emulate, int fanout, double rate, double mc_frac,
+                          uint64_t cycles, uint64_t seed) {
+    NocChain* ch = new NocChain(seed);
+    ch->apply_reset();
+    ch->traffic.rate = rate;
+    ch->traffic.mc_frac = mc_frac;
+    ch->traffic.mc_fanout = fanout;
+    ch->traffic.mc_emulate = emulate;
+    for (uint64_t c = 0; c < cycles; c++) ch->tick();
+    ch->drain(20 * cycles);
+
+    McResult r;
+    r.messages = ch->messages;
+    r.link_flits = ch->link_flits;
+    r.delivered = ch->delivered;
+    r.cycles = ch->cycle;
+    r.latency = ch->delivered ? (double)ch->latency_sum / ch->delivered : 0.0;
+    r.errors = ch->errors;
+    delete ch;
+    return r;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    uint64_t cycles = tb_arg_int(argc, argv, "cycles", 10000);
+    double mc_frac = tb_arg_double(argc, argv, "mc-frac", 0.5);
+    uint64_t seed = tb_arg_int(argc, argv, "seed", 1);
+
+    printf("noc_router multicast test: NUM_PORTS=%d FIFO_DEPTH=%d\n", NUM_PORTS, FIFO_DEPTH);
+    directed_tests();
+    chain_tests();
+
+    // Occupancy: fraction of cycles (until everything is delivered) the
+    // A -> B link carried a packet
+    const int fanouts[] = {2, CHAIN_N};
+    printf("\n%-7s %5s %9s %10s %10s %8s %7s %7s %9s %9s %8s %8s\n", "fanout", "rate", "messages",
+           "link_uc", "link_mc", "saved", "occ_uc", "occ_mc", "cyc_uc", "cyc_mc", "lat_uc", "lat_mc");
+    for (int fanout : fanouts) {
+        for (double rate : RATES) {
+            McResult uc = run_chain(true, fanout, rate, mc_frac, cycles, seed);
+            McResult mc = run_chain(false, fanout, rate, mc_frac, cycles, seed);
+            double saved = uc.link_flits ? 1.0 - (double)mc.link_flits / uc.link_flits : 0.0;
+            double occ_uc = uc.cycles ? (double)uc.link_flits / uc.cycles : 0.0;
+            double occ_mc = mc.cycles ? (double)mc.link_flits / mc.cycles : 0.0;
+
+            printf("%-7d %5.2f %9llu %10llu %10llu %7.1f%% %7.3f %7.3f %9llu %9llu %8.2f %8.2f\n",
+                   fanout, rate, (unsigned long long)mc.messages,
+                   (unsigned long long)uc.link_flits, (unsigned long long)mc.link_flits,
+                   100.0 * saved, occ_uc, occ_mc, (unsigned long long)uc.cycles,
+                   (unsigned long long)mc.cycles, uc.latency, mc.latency);
+            printf("RESULT fanout=%d rate=%.2f link_flits_uc=%llu link_flits_mc=%llu saved=%.4f "
+                   "errors=%d\n", fanout, rate, (unsigned long long)uc.link_flits,
+                   (unsigned long long)mc.link_flits, saved, uc.errors + mc.errors);
+
+            // Same messages, same copies delivered, fewer flits on the link
+            check(uc.errors == 0 && mc.errors == 0, "scoreboard errors in comparison run");
+            check(uc.messages == mc.messages && uc.delivered == mc.delivered,
+                  "multicast and emulation delivered different copies");
+            check(mc_frac == 0 || mc.link_flits < uc.link_flits, "multicast did not save link flits");
+        }
+    }
+
+    printf("\n%d/%d tests passed\n", passed, test_count);
+    return passed == test_count ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+#include <iostream>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include "noc_router_harness.h"
+#include "noc_router_checkpoint.h"
+
+// Long-running soak test with checkpoint/restore (verilator --savable).
+//
+// Soak run: random traffic for --cycles cycles, saving a checkpoint every
+// --checkpoint-every cycles into --checkpoint-dir (the newest --keep are
+// kept). On the first scoreboard failure the run stops and names the
+// newest checkpoint taken before it. A watchdog treats --watchdog cycles
+// without a delivery while packets are outstanding (deadlock or livelock)
+// as a failure as well.
+//
+// Replay: --restore=FILE reloads model + harness state and continues with
+// full VCD tracing (--vcd, default noc_router_restore.vcd) for --cycles
+// more cycles, so a late failure can be inspected without re-simulating
+// from reset. Traffic options are taken from the checkpoint.
+//
+// Self test: --selftest checks that a restored run matches an
+// uninterrupted one.
+//
+// Options: --cycles=N --rate=R --pattern=uniform|hotspot|shift --seed=S
+//          --checkpoint-every=N --checkpoint-dir=DIR --keep=K --watchdog=N
+//          --restore=FILE --vcd=FILE --trace=0|1
+
+static std::string checkpoint_path(const std::string& dir, uint64_t cycle) {
+    return dir + "/noc_router_" + std::to_string(cycle) + ".ckpt";
+}
+
+// Run to `until`, checkpointing on the way; returns false on failure
+static bool soak(NocRouterHarness* tb, uint64_t until, uint64_t every,
+                 const std::string& dir, size_t keep, uint64_t watchdog) {
+    std::deque<std::string> saved;
+    uint64_t last_delivered = tb->delivered;
+    uint64_t last_progress = tb->cycle;
+    while (tb->cycle < until) {
+        tb->tick();
+
+        // Watchdog: packets outstanding but nothing delivered
+        if (tb->delivered != last_delivered || tb->idle()) {
+            last_delivered = tb->delivered;
+            last_progress = tb->cycle;
+        } else if (watchdog && tb->cycle - last_progress >= watchdog) {
+            tb->errors++;
+            printf("FAIL cycle %llu: no packet delivered for %llu cycles with packets outstanding\n",
+                   (unsigned long long)tb->cycle, (unsigned long long)watchdog);
+        }
+
+        if (tb->errors > 0) {
+            printf("\nFirst failure at cycle %llu\n", (unsigned long long)tb->cycle);
+            if (!saved.empty())
+                printf("Replay with: --restore=%s\n", saved.back().c_str());
+            else
+                printf("No checkpoint taken yet, replay from reset with --trace=1\n");
+            return false;
+        }
+
+        if (every && tb->cycle % every == 0) {
+            std::string path = checkpoint_path(dir, tb->cycle);
+            if (!save_checkpoint(*tb, path)) return false;
+            saved.push_back(path);
+            while (saved.size() > keep) {
+                std::remove(saved.front().c_str());
+                saved.pop_front();
+            }
+        }
+    }
+    return true;
+}
+
+// A run restored from a mid-point checkpoint must end in the same state
+// as one that never stopped
+static bool selftest(const std::string& dir) {
+    const uint64_t half = 2000;
+    int test_count = 0;
+    int passed = 0;
+
+    NocRouterHarness* ref = new NocRouterHarness(7);
+    ref->apply_reset();
+    ref->traffic.pattern = TRAFFIC_HOTSPOT;
+    ref->traffic.rate = 0.3;
+    ref->run(half);
+    std::string path = checkpoint_path(dir, half);
+    bool saved = save_checkpoint(*ref, path);
+    ref->run(half);
+
+    NocRouterHarness* rst = new NocRouterHarness(1);
+    bool restored = saved && restore_checkpoint(*rst, path);
+    if (restored) rst->run(half);
+
+    test_count++;
+    if (restored) passed++;
+    else printf("FAIL: checkpoint save/restore\n");
+
+    test_count++;
+    if (restored && rst->cycle == ref->cycle && rst->injected == ref->injected &&
+        rst->delivered == ref->delivered && rst->latency_sum == ref->latency_sum &&
+        rst->rng.s == ref->rng.s) {
+        passed++;
+    } else {
+        printf("FAIL: restored run diverged (delivered %llu vs %llu)\n",
+               (unsigned long long)rst->delivered, (unsigned long long)ref->delivered);
+    }
+
+    test_count++;
+    bool same_outputs = restored && rst->dut->out_valid == ref->dut->out_valid;
+    for (int o = 0; same_outputs && o < NUM_PORTS; o++) {
+        Packet a, b;
+        from_model(a, rst->dut->out_packet[o]);
+        from_model(b, ref->dut->out_packet[o]);
+        same_outputs = memcmp(&a, &b, sizeof(a)) == 0;
+    }
+    if (same_outputs) passed++;
+    else printf("FAIL: restored model outputs differ\n");
+
+    test_count++;
+    if (restored && ref->drain() && rst->drain() && ref->errors == 0 && rst->errors == 0) passed++;
+    else printf("FAIL: scoreboard errors after restore\n");
+
+    std::remove(path.c_str());
+    delete rst;
+    delete ref;
+
+    printf("\n%d/%d tests passed\n", passed, test_count);
+    return passed == test_count;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    uint64_t cycles = tb_arg_int(argc, argv, "cycles", 1000000);
+    uint64_t every = tb_arg_int(argc, argv, "checkpoint-every", 100000);
+    size_t keep = tb_arg_int(argc, argv, "keep", 4);
+    const char* dir_s = tb_arg(argc, argv, "checkpoint-dir");
+    std::string dir = dir_s ? dir_s : ".";
+    const char* restore = tb_arg(argc, argv, "restore");
+    const char* vcd = tb_arg(argc, argv, "vcd");
+    uint64_t watchdog = tb_arg_int(argc, argv, "watchdog", 10000);
+
+    if (tb_arg_int(argc, argv, "selftest", 0)) {
+        printf("noc_router checkpoint self test\n");
+        return selftest(dir) ? 0 : 1;
+    }
+
+    NocRouterHarness* tb = new NocRouterHarness(tb_arg_int(argc, argv, "seed", 1));
+
+    if (restore) {
+        if (!restore_checkpoint(*tb, restore)) {
+            delete tb;
+            return 1;
+        }
+        printf("Restored %s at cycle %llu\n", restore, (unsigned long long)tb->cycle);
+        // --cycles counts from the checkpoint
+        cycles += tb->cycle;
+        // Full tracing from the checkpoint onwards
+        if (tb_arg_int(argc, argv, "trace", 1))
+            tb->trace_open(vcd ? vcd : "noc_router_restore.vcd");
+        // Replays are for debugging, no new checkpoints by default
+        every = tb_arg_int(argc, argv, "checkpoint-every", 0);
+    } else {
+        if (tb_arg_int(argc, argv, "trace", 0))
+            tb->trace_open(vcd ? vcd : "noc_router_soak.vcd");
+        tb->apply_reset();
+        tb->traffic.pattern = parse_pattern(tb_arg(argc, argv, "pattern"));
+        tb->traffic.rate = tb_arg_double(argc, argv, "rate", 0.3);
+        tb->clear_stats();
+    }
+
+    bool success = soak(tb, cycles, every, dir, keep, watchdog);
+    if (success) success = tb->drain();
+
+    printf("noc_router soak run\n");
+    printf("cycles            %llu\n", (unsigned long long)tb->cycle);
+    tb->report();
+
+    success = success && tb->errors == 0;
+    delete tb;
+    return success ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# noc_router design-space sweep (FIFO_DEPTH x PACKET_WIDTH x NUM_PORTS)
+#
+# Extra arguments are passed to noc_router_dse, e.g.
+#   ./run_dse.sh --ports=4,5 --fifo-depth=4,8 --packet-width=128 --jobs=8
+# Builds are cached in dse_cache/; rerunning only rebuilds changed points.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RTL_DIR="$SCRIPT_DIR/../../rtl"
+
+echo "Building noc_router_dse..."
+g++ -O2 -std=c++17 -pthread -o "$SCRIPT_DIR/noc_router_dse" "$SCRIPT_DIR/noc_router_dse.cpp"
+
+"$SCRIPT_DIR/noc_router_dse" --rtl="$RTL_DIR" --tb="$SCRIPT_DIR" \
+    --cache="$SCRIPT_DIR/dse_cache" --csv="$SCRIPT_DIR/dse_results.csv" "$@"
@@ -0,0 +1,28 @@
+#!/bin/bash
+
+# noc_router multicast test and A -> B link bandwidth comparison against unicast emulation
+#
+# Extra arguments are passed to the test, e.g.
+#   ./run_multicast.sh --cycles=20000 --mc-frac=0.25
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RTL_DIR="$SCRIPT_DIR/../../rtl"
+COMMON_DIR="$SCRIPT_DIR/../common"
+OBJ_DIR="$SCRIPT_DIR/obj_dir_multicast"
+
+echo "Building noc_router multicast testbench..."
+
+rm -rf "$OBJ_DIR"
+
+verilator -F "$RTL_DIR/noc_router.f" --trace -cc \
+    --top-module noc_router \
+    -CFLAGS "-O2 -I$COMMON_DIR" \
+    --exe "$SCRIPT_DIR/noc_router_multicast_tb.cpp" \
+    -Mdir "$OBJ_DIR"
+
+make -C "$OBJ_DIR" -f Vnoc_router.mk Vnoc_router
+
+echo "Running noc_router multicast test..."
+"$OBJ_DIR/Vnoc_router" "$@"
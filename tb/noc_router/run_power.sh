@@ -0,0 +1,45 @@
+#!/bin/bash
+
+# noc_router activity-driven power flow (Verilator + vcd_activity)
+#
+# Builds the router with and without clock gating, runs the same
+# representative traffic on both, and converts each VCD into
+#   vcd_saif/noc_router_gate<0|1>.saif          (for synthesis_dc.tcl / genus)
+#   vcd_saif/noc_router_gate<0|1>.activity.rpt  (per-module toggle summary)
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RTL_DIR="$SCRIPT_DIR/../../rtl"
+COMMON_DIR="$SCRIPT_DIR/../common"
+SAIF_DIR="$SCRIPT_DIR/../../vcd_saif"
+
+CYCLES=${CYCLES:-20000}
+RATE=${RATE:-0.2}
+
+echo "Building vcd_activity..."
+g++ -O2 -std=c++17 -o "$SAIF_DIR/vcd_activity" "$SAIF_DIR/vcd_activity.cpp"
+
+for GATE in 0 1; do
+    OBJ_DIR="$SCRIPT_DIR/obj_dir_gate$GATE"
+    VCD="$SAIF_DIR/noc_router_gate$GATE.vcd"
+
+    echo "Building noc_router (CLK_GATE=$GATE)..."
+    rm -rf "$OBJ_DIR"
+    verilator -F "$RTL_DIR/noc_router.f" --trace -cc \
+        --top-module noc_router -GCLK_GATE=$GATE \
+        -CFLAGS "-I$COMMON_DIR -DCLK_GATE=$GATE" \
+        --exe "$SCRIPT_DIR/noc_router_power_tb.cpp" \
+        -Mdir "$OBJ_DIR"
+    make -C "$OBJ_DIR" -f Vnoc_router.mk Vnoc_router
+
+    echo "Running noc_router activity capture (CLK_GATE=$GATE)..."
+    "$OBJ_DIR/Vnoc_router" --cycles=$CYCLES --rate=$RATE --vcd="$VCD" | tee "$OBJ_DIR/run.log"
+    FLITS=$(awk '/^FLITS/ {print $2}' "$OBJ_DIR/run.log")
+
+    "$SAIF_DIR/vcd_activity" "$VCD" --saif="$SAIF_DIR/noc_router_gate$GATE.saif" --flits=$FLITS \
+        > "$SAIF_DIR/noc_router_gate$GATE.activity.rpt"
+    cat "$SAIF_DIR/noc_router_gate$GATE.activity.rpt"
+done
+
+echo "SAIF files saved to $SAIF_DIR (instance TOP/noc_router)"
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# noc_router soak test with checkpoint/restore (verilator --savable)
+#
+# Extra arguments are passed to the soak run, e.g.
+#   ./run_soak.sh --cycles=1000000000 --checkpoint-every=10000000
+#   ./run_soak.sh --restore=checkpoints/noc_router_990000000.ckpt --cycles=100000
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RTL_DIR="$SCRIPT_DIR/../../rtl"
+COMMON_DIR="$SCRIPT_DIR/../common"
+OBJ_DIR="$SCRIPT_DIR/obj_dir_soak"
+CKPT_DIR="$SCRIPT_DIR/checkpoints"
+
+echo "Building noc_router soak testbench..."
+
+# Keep previous build: make only recompiles what changed
+verilator -F "$RTL_DIR/noc_router.f" --trace --savable -cc \
+    --top-module noc_router \
+    -CFLAGS "-O2 -I$COMMON_DIR" \
+    --exe "$SCRIPT_DIR/noc_router_soak_tb.cpp" \
+    -Mdir "$OBJ_DIR"
+
+make -C "$OBJ_DIR" -f Vnoc_router.mk Vnoc_router
+
+mkdir -p "$CKPT_DIR"
+
+echo "Running checkpoint self test..."
+"$OBJ_DIR/Vnoc_router" --selftest=1 --checkpoint-dir="$CKPT_DIR"
+
+echo "Running noc_router soak..."
+"$OBJ_DIR/Vnoc_router" --checkpoint-dir="$CKPT_DIR" "$@"
@@ -41,7 +41,10 @@ module tb_input_port;
     .in_ready(in_ready),
     .fifo_empty(fifo_empty),
     .fifo_rd_data(fifo_rd_data),
-    .fifo_rd_en(fifo_rd_en)
+    .fifo_rd_en(fifo_rd_en),
+    .mc_req(),
+    .mc_rd_data(),
+    .mc_grant('0)
   );
 
   initial clk = 1'b0;
@@ -0,0 +1,463 @@
+// VCD -> SAIF converter and per-module toggle-rate summary.
+//
+// Reads a VCD dump (Verilator or Icarus), accumulates per-bit T0/T1/TX time
+// and 0<->1 toggle counts, then
+//   * writes a SAIF 2.0 (backward) file for read_saif in synthesis_dc.tcl /
+//     read_activity_file in synthesis_genus.tcl, and
+//   * prints a toggle-rate summary grouped by module instance, with
+//     generate indices folded ("VOQ[3]" -> "VOQ[*]") so identical
+//     instances are reported together.
+//
+// Usage:
+//   vcd_activity <file.vcd> [--saif=out.saif] [--clock=clk] [--flits=N]
+//                           [--hier]
+//
+//   --clock  leaf name of the clock used to count cycles (default clk)
+//   --flits  packets delivered during the run, adds toggles/flit and
+//            time/flit (multiply report_power by it for energy per flit)
+//   --hier   also print every instance, not just the folded groups
+//
+// Derived clocks (1-bit nets named *clk other than --clock, e.g. a gated
+// fifo_clk) are listed with their rising edges per cycle: the fraction of
+// cycles the registers behind them are clocked.
+//
+// Build: g++ -O2 -std=c++17 -o vcd_activity vcd_activity.cpp
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One VCD identifier code; several $var lines may alias it
+struct Signal {
+    int width = 1;
+    uint64_t last_time = 0;
+    std::vector<char> val;          // per bit, bit 0 = LSB: '0' '1' 'x' 'z'
+    std::vector<uint64_t> t0, t1, tx, tc;
+};
+
+struct Var {
+    std::string name;
+    int sig;
+    int msb;
+    int lsb;
+    bool ranged;
+};
+
+struct Scope {
+    std::string name;
+    int parent;
+    std::vector<int> children;
+    std::vector<int> vars;
+};
+
+static std::vector<Signal> sigs;
+static std::vector<Var> vars;
+static std::vector<Scope> scopes;
+static std::unordered_map<std::string, int> id_map;
+
+static const char* opt(int argc, char** argv, const char* key) {
+    size_t n = strlen(key);
+    for (int i = 2; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0 && strncmp(argv[i] + 2, key, n) == 0) {
+            const char* rest = argv[i] + 2 + n;
+            if (*rest == '=') return rest + 1;
+            if (*rest == '\0') return "";
+        }
+    }
+    return nullptr;
+}
+
+// -----------------------------
+// Activity accumulation
+// -----------------------------
+static void advance(Signal& s, uint64_t t) {
+    uint64_t dt = t - s.last_time;
+    if (dt == 0) return;
+    for (int b = 0; b < s.width; b++) {
+        switch (s.val[b]) {
+        case '0': s.t0[b] += dt; break;
+        case '1': s.t1[b] += dt; break;
+        default:  s.tx[b] += dt; break;
+        }
+    }
+    s.last_time = t;
+}
+
+static char norm(char c) {
+    switch (c) {
+    case '0': return '0';
+    case '1': return '1';
+    case 'z': case 'Z': return 'z';
+    default:  return 'x';
+    }
+}
+
+// Apply a value given MSB first; shorter values are left-extended per VCD
+static void change(Signal& s, const char* v, size_t len, uint64_t t) {
+    advance(s, t);
+    char pad = (len && (norm(v[0]) == 'x' || norm(v[0]) == 'z')) ? norm(v[0]) : '0';
+    for (int b = 0; b < s.width; b++) {
+        char c = (b < (int)len) ? norm(v[len - 1 - b]) : pad;
+        char old = s.val[b];
+        if ((old == '0' && c == '1') || (old == '1' && c == '0'))
+            s.tc[b]++;
+        s.val[b] = c;
+    }
+}
+
+// -----------------------------
+// VCD parsing
+// -----------------------------
+static bool parse_vcd(const char* path, std::string& timescale, uint64_t& end_time) {
+    std::ifstream in(path);
+    if (!in) {
+        fprintf(stderr, "ERROR: cannot open %s\n", path);
+        return false;
+    }
+
+    std::string tok;
+    int cur_scope = -1;
+
+    // Header
+    while (in >> tok) {
+        if (tok == "$timescale") {
+            timescale.clear();
+            while (in >> tok && tok != "$end") timescale += tok;
+        } else if (tok == "$scope") {
+            std::string type, name;
+            in >> type >> name >> tok;
+            Scope sc;
+            sc.name = name;
+            sc.parent = cur_scope;
+            scopes.push_back(sc);
+            int idx = (int)scopes.size() - 1;
+            if (cur_scope >= 0) scopes[cur_scope].children.push_back(idx);
+            cur_scope = idx;
+        } else if (tok == "$upscope") {
+            in >> tok;
+            if (cur_scope >= 0) cur_scope = scopes[cur_scope].parent;
+        } else if (tok == "$var") {
+            std::string type, width, id, name;
+            in >> type >> width >> id >> name;
+            Var v;
+            v.name = name;
+            v.msb = atoi(width.c_str()) - 1;
+            v.lsb = 0;
+            v.ranged = false;
+            while (in >> tok && tok != "$end") {
+                if (tok[0] == '[') {
+                    v.ranged = true;
+                    const char* colon = strchr(tok.c_str(), ':');
+                    v.msb = atoi(tok.c_str() + 1);
+                    v.lsb = colon ? atoi(colon + 1) : v.msb;
+                }
+            }
+            // Parameters are constants, not nets: they would show up in the
+            // SAIF with TC 0 and dilute the per-module toggle rates
+            if (type.find("parameter") != std::string::npos) continue;
+            auto it = id_map.find(id);
+            if (it == id_map.end()) {
+                Signal s;
+                s.width = atoi(width.c_str());
+                s.val.assign(s.width, 'x');
+                s.t0.assign(s.width, 0);
+                s.t1.assign(s.width, 0);
+                s.tx.assign(s.width, 0);
+                s.tc.assign(s.width, 0);
+                sigs.push_back(s);
+                it = id_map.emplace(id, (int)sigs.size() - 1).first;
+            }
+            v.sig = it->second;
+            vars.push_back(v);
+            if (cur_scope >= 0) scopes[cur_scope].vars.push_back((int)vars.size() - 1);
+        } else if (tok == "$enddefinitions") {
+            in >> tok;
+            break;
+        } else if (tok[0] == '$') {
+            // $date, $version, $comment: skip to $end
+            while (tok != "$end" && in >> tok) {}
+        }
+    }
+
+    // Value changes
+    uint64_t t = 0;
+    std::string id;
+    while (in >> tok) {
+        char c = tok[0];
+        if (c == '#') {
+            t = strtoull(tok.c_str() + 1, nullptr, 10);
+        } else if (c == 'b' || c == 'B') {
+            in >> id;
+            auto it = id_map.find(id);
+            if (it != id_map.end())
+                change(sigs[it->second], tok.c_str() + 1, tok.size() - 1, t);
+        } else if (c == 'r' || c == 'R') {
+            in >> id; // real values carry no toggle information
+        } else if (c == '$') {
+            continue; // $dumpvars / $end / $dumpall ...
+        } else {
+            auto it = id_map.find(tok.substr(1));
+            if (it != id_map.end())
+                change(sigs[it->second], tok.c_str(), 1, t);
+        }
+    }
+
+    end_time = t;
+    for (auto& s : sigs) advance(s, end_time);
+    return true;
+}
+
+// -----------------------------
+// SAIF output
+// -----------------------------
+static std::string saif_escape(const std::string& n) {
+    std::string out;
+    for (char c : n) {
+        if (c == '[' || c == ']' || c == '(' || c == ')' || c == '/' || c == '.')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void write_saif_scope(FILE* f, int si, int indent) {
+    const Scope& sc = scopes[si];
+    std::string pad(indent, ' ');
+    fprintf(f, "%s(INSTANCE %s\n", pad.c_str(), saif_escape(sc.name).c_str());
+    if (!sc.vars.empty()) {
+        fprintf(f, "%s  (NET\n", pad.c_str());
+        for (int vi : sc.vars) {
+            const Var& v = vars[vi];
+            const Signal& s = sigs[v.sig];
+            for (int b = 0; b < s.width; b++) {
+                std::string net = saif_escape(v.name);
+                if (v.ranged || s.width > 1) {
+                    int idx = (v.msb >= v.lsb) ? v.lsb + b : v.lsb - b;
+                    net += "\\[" + std::to_string(idx) + "\\]";
+                }
+                fprintf(f, "%s    (%s\n%s      (T0 %llu) (T1 %llu) (TX %llu)\n%s      (TC %llu) (IG 0)\n%s    )\n",
+                        pad.c_str(), net.c_str(),
+                        pad.c_str(), (unsigned long long)s.t0[b], (unsigned long long)s.t1[b],
+                        (unsigned long long)s.tx[b],
+                        pad.c_str(), (unsigned long long)s.tc[b], pad.c_str());
+            }
+        }
+        fprintf(f, "%s  )\n", pad.c_str());
+    }
+    for (int ci : sc.children) write_saif_scope(f, ci, indent + 2);
+    fprintf(f, "%s)\n", pad.c_str());
+}
+
+static bool write_saif(const char* path, const std::string& timescale, uint64_t duration) {
+    FILE* f = fopen(path, "w");
+    if (!f) {
+        fprintf(stderr, "ERROR: cannot write %s\n", path);
+        return false;
+    }
+    // "1ps" -> "1 ps"
+    size_t u = timescale.find_first_not_of("0123456789");
+    std::string ts_num = timescale.substr(0, u);
+    std::string ts_unit = (u == std::string::npos) ? "ps" : timescale.substr(u);
+
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y", localtime(&now));
+
+    fprintf(f, "(SAIFILE\n");
+    fprintf(f, "(SAIFVERSION \"2.0\")\n");
+    fprintf(f, "(DIRECTION \"backward\")\n");
+    fprintf(f, "(DESIGN )\n");
+    fprintf(f, "(DATE \"%s\")\n", date);
+    fprintf(f, "(VENDOR \"Utility-Chiplet\")\n");
+    fprintf(f, "(PROGRAM_NAME \"vcd_activity\")\n");
+    fprintf(f, "(VERSION \"1.0\")\n");
+    fprintf(f, "(DIVIDER / )\n");
+    fprintf(f, "(TIMESCALE %s %s)\n", ts_num.empty() ? "1" : ts_num.c_str(), ts_unit.c_str());
+    fprintf(f, "(DURATION %llu)\n", (unsigned long long)duration);
+    for (size_t si = 0; si < scopes.size(); si++)
+        if (scopes[si].parent < 0) write_saif_scope(f, (int)si, 0);
+    fprintf(f, ")\n");
+    fclose(f);
+    return true;
+}
+
+// -----------------------------
+// Toggle summary
+// -----------------------------
+struct Activity {
+    uint64_t bits = 0;
+    uint64_t toggles = 0;
+    int instances = 0;
+};
+
+static std::string scope_path(int si) {
+    std::string p = scopes[si].name;
+    for (int s = scopes[si].parent; s >= 0; s = scopes[s].parent)
+        p = scopes[s].name + "." + p;
+    return p;
+}
+
+// "IN_PORTS[2].ip.VOQ[4]" -> "IN_PORTS[*].ip.VOQ[*]" (also handles "(n)")
+static std::string fold_indices(const std::string& p) {
+    std::string out;
+    for (size_t i = 0; i < p.size(); i++) {
+        char c = p[i];
+        out += c;
+        if (c == '[' || c == '(') {
+            size_t j = i + 1;
+            while (j < p.size() && isdigit((unsigned char)p[j])) j++;
+            if (j > i + 1) {
+                out += '*';
+                i = j - 1;
+            }
+        }
+    }
+    return out;
+}
+
+// Nets visible in a scope itself (ports included, children excluded)
+static Activity own_activity(int si) {
+    Activity a;
+    a.instances = 1;
+    for (int vi : scopes[si].vars) {
+        const Signal& s = sigs[vars[vi].sig];
+        a.bits += s.width;
+        for (int b = 0; b < s.width; b++) a.toggles += s.tc[b];
+    }
+    return a;
+}
+
+static void print_row(const std::string& name, const Activity& a, double cycles, double flits) {
+    double rate = (a.bits && cycles > 0) ? (double)a.toggles / ((double)a.bits * cycles) : 0.0;
+    printf("%-56s %4d %8llu %12llu %10.5f", name.c_str(), a.instances,
+           (unsigned long long)a.bits, (unsigned long long)a.toggles, rate);
+    if (flits > 0) printf(" %12.2f", (double)a.toggles / flits);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <file.vcd> [--saif=out.saif] [--clock=clk] [--flits=N] [--hier]\n", argv[0]);
+        return 1;
+    }
+
+    const char* saif = opt(argc, argv, "saif");
+    const char* clock = opt(argc, argv, "clock");
+    const char* flits_s = opt(argc, argv, "flits");
+    bool hier = opt(argc, argv, "hier") != nullptr;
+    std::string clk_name = clock ? clock : "clk";
+    double flits = flits_s ? atof(flits_s) : 0.0;
+
+    std::string timescale = "1ps";
+    uint64_t end_time = 0;
+    if (!parse_vcd(argv[1], timescale, end_time)) return 1;
+
+    if (saif && *saif) {
+        if (!write_saif(saif, timescale, end_time)) return 1;
+        printf("SAIF written to %s\n", saif);
+    }
+
+    // Cycle count from the shallowest clock net
+    double cycles = 0;
+    int best_depth = 1 << 30;
+    for (size_t si = 0; si < scopes.size(); si++) {
+        int depth = 0;
+        for (int s = scopes[si].parent; s >= 0; s = scopes[s].parent) depth++;
+        for (int vi : scopes[si].vars) {
+            if (vars[vi].name == clk_name && depth < best_depth) {
+                best_depth = depth;
+                cycles = sigs[vars[vi].sig].tc[0] / 2.0;
+            }
+        }
+    }
+    if (cycles == 0) {
+        fprintf(stderr, "WARNING: clock '%s' not found, rates are per time unit\n", clk_name.c_str());
+        cycles = (double)end_time;
+    }
+
+    printf("\nduration          %llu (%s units)\n", (unsigned long long)end_time, timescale.c_str());
+    printf("cycles            %.0f\n", cycles);
+    if (flits > 0) {
+        printf("flits             %.0f\n", flits);
+        printf("time per flit     %.3f (%s units)  -> energy/flit = total power x this\n",
+               (double)end_time / flits, timescale.c_str());
+    }
+
+    // Folded per-module groups, in first-seen order
+    std::vector<std::string> order;
+    std::map<std::string, Activity> groups;
+    for (size_t si = 0; si < scopes.size(); si++) {
+        std::string key = fold_indices(scope_path((int)si));
+        Activity a = own_activity((int)si);
+        auto it = groups.find(key);
+        if (it == groups.end()) {
+            order.push_back(key);
+            groups[key] = a;
+        } else {
+            it->second.bits += a.bits;
+            it->second.toggles += a.toggles;
+            it->second.instances++;
+        }
+    }
+
+    printf("\n%-56s %4s %8s %12s %10s", "module instance (own nets)", "inst", "bits", "toggles", "rate");
+    if (flits > 0) printf(" %12s", "toggles/flit");
+    printf("\n");
+    for (const auto& key : order) print_row(key, groups[key], cycles, flits);
+
+    if (hier) {
+        printf("\n");
+        for (size_t si = 0; si < scopes.size(); si++)
+            print_row(scope_path((int)si), own_activity((int)si), cycles, flits);
+    }
+
+    // Design total over unique nets (aliases counted once)
+    Activity total;
+    total.instances = (int)scopes.size();
+    for (const auto& s : sigs) {
+        total.bits += s.width;
+        for (int b = 0; b < s.width; b++) total.toggles += s.tc[b];
+    }
+    printf("\n");
+    print_row("TOTAL (unique nets)", total, cycles, flits);
+
+    // Derived clocks, folded like the module groups
+    std::vector<std::string> clk_order;
+    std::map<std::string, Activity> clks;
+    for (size_t si = 0; si < scopes.size(); si++) {
+        for (int vi : scopes[si].vars) {
+            const Var& v = vars[vi];
+            const Signal& s = sigs[v.sig];
+            size_t n = v.name.size();
+            if (s.width != 1 || v.name == clk_name || n < 3 || v.name.compare(n - 3, 3, "clk") != 0)
+                continue;
+            std::string key = fold_indices(scope_path((int)si)) + "." + v.name;
+            auto it = clks.find(key);
+            if (it == clks.end()) {
+                clk_order.push_back(key);
+                it = clks.emplace(key, Activity()).first;
+            }
+            it->second.toggles += s.tc[0];
+            it->second.instances++;
+        }
+    }
+    if (!clk_order.empty() && cycles > 0) {
+        printf("\n%-56s %4s %12s\n", "derived clock", "inst", "edges/cycle");
+        for (const auto& key : clk_order) {
+            const Activity& a = clks[key];
+            printf("%-56s %4d %12.4f\n", key.c_str(), a.instances,
+                   (double)a.toggles / 2.0 / a.instances / cycles);
+        }
+    }
+
+    return 0;
+}